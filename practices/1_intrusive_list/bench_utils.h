@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+    template<typename T>
+    void do_not_optimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile char const *sink;
+        sink = reinterpret_cast<char const volatile *>(&value);
+#endif
+    }
+
+    // Runs setup() and then f() repeats times and returns the best time of f() in nanoseconds.
+    template<typename Setup, typename F>
+    double measure_ns(std::size_t repeats, Setup &&setup, F &&f) {
+        double best = 0;
+        for (std::size_t i = 0; i < repeats; ++i) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto finish = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double, std::nano>(finish - start).count();
+            if (i == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        return best;
+    }
+
+    // Order in which nodes are linked: either the order they were allocated in, or a random one.
+    inline std::vector<std::size_t> link_order(std::size_t n, bool shuffled) {
+        std::vector<std::size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        if (shuffled) {
+            std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+        }
+        return order;
+    }
+
+    struct result {
+        std::string name;
+        std::size_t items;
+        double ns;
+    };
+
+    // Collects the results of a run. Names are slash-separated paths with "key:value"
+    // parameters, e.g. "ops/push_back/std::list/bytes:64/order:shuffled/length:1000".
+    struct reporter {
+        bool json = false;
+        std::vector<result> results;
+
+        // Human-readable output goes to stderr when stdout is taken by JSON.
+        std::FILE *log() const noexcept {
+            return json ? stderr : stdout;
+        }
+
+        void add(std::string name, std::size_t items, double ns) {
+            std::fprintf(log(), "%-80s %10zu items %12.3f ms %8.2f ns/item\n",
+                         name.c_str(), items, ns / 1e6, ns / items);
+            results.push_back({std::move(name), items, ns});
+        }
+
+        void write_json(std::FILE *out) const {
+            std::fprintf(out, "{\n  \"context\": {\n");
+#if defined(__VERSION__)
+            std::fprintf(out, "    \"compiler\": \"%s\",\n", escape(__VERSION__).c_str());
+#endif
+#if defined(NDEBUG)
+            std::fprintf(out, "    \"assertions\": false,\n");
+#else
+            std::fprintf(out, "    \"assertions\": true,\n");
+#endif
+            std::fprintf(out, "    \"hardware_concurrency\": %u\n  },\n  \"benchmarks\": [", std::thread::hardware_concurrency());
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                result const &r = results[i];
+                std::fprintf(out, "%s\n    {\"name\": \"%s\", \"items\": %zu, \"time_ns\": %.1f, \"ns_per_item\": %.3f}",
+                             i == 0 ? "" : ",", escape(r.name).c_str(), r.items, r.ns, r.ns / r.items);
+            }
+            std::fprintf(out, "\n  ]\n}\n");
+        }
+
+    private:
+        static std::string escape(std::string const &s) {
+            std::string escaped;
+            for (char c : s) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                }
+                escaped += c;
+            }
+            return escaped;
+        }
+    };
+
+    inline reporter &current_reporter() {
+        static reporter instance;
+        return instance;
+    }
+
+    inline std::FILE *log() {
+        return current_reporter().log();
+    }
+
+    inline void report(std::string name, std::size_t n, double ns) {
+        current_reporter().add(std::move(name), n, ns);
+    }
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace intrusive {
+
+    struct default_tag;
+
+    // Hook that stores links as 32-bit byte offsets from the base of an arena
+    // instead of pointers: 8 bytes per membership instead of 16 (plus vptr) of list_element.
+    // It has no virtual destructor and does not unlink itself on destruction.
+    template<typename Tag = default_tag>
+    struct compact_list_element {
+        static constexpr std::uint32_t head_offset = 0xFFFFFFFF;
+        static constexpr std::uint32_t detached_offset = 0xFFFFFFFE;
+
+        std::uint32_t next = detached_offset;
+        std::uint32_t prev = detached_offset;
+
+        bool is_linked() const noexcept {
+            return next != detached_offset;
+        }
+    };
+
+    template<typename T, typename Tag>
+    struct compact_list;
+
+    template<typename T, typename Tag>
+    struct compact_list_iterator {
+
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::remove_const_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *;
+        using reference = T &;
+        using owner_t = compact_list<value_type, Tag>;
+
+        compact_list_iterator() = default;
+
+        template<typename V>
+        compact_list_iterator(compact_list_iterator<V, Tag> other, std::enable_if_t<
+                std::is_same_v<V, std::remove_const_t<T>> && std::is_const_v<T>> * = nullptr) noexcept
+                : owner(other.owner), offset(other.offset) {}
+
+        T &operator*() const noexcept {
+            return static_cast<T &>(*owner->hook_at(offset));
+        }
+
+        T *operator->() const noexcept {
+            return &**this;
+        }
+
+        compact_list_iterator &operator++() & noexcept {
+            offset = owner->hook_at(offset)->next;
+            return *this;
+        }
+
+        compact_list_iterator &operator--() & noexcept {
+            offset = owner->hook_at(offset)->prev;
+            return *this;
+        }
+
+        compact_list_iterator operator++(int) & noexcept {
+            compact_list_iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        compact_list_iterator operator--(int) & noexcept {
+            compact_list_iterator temp = *this;
+            --*this;
+            return temp;
+        }
+
+        bool operator==(compact_list_iterator const &rhs) const & noexcept {
+            return offset == rhs.offset;
+        }
+
+        bool operator!=(compact_list_iterator const &rhs) const & noexcept {
+            return offset != rhs.offset;
+        }
+
+        compact_list_iterator(owner_t const *owner, std::uint32_t offset) noexcept: owner(owner), offset(offset) {}
+
+        owner_t const *owner = nullptr;
+        std::uint32_t offset = compact_list_element<Tag>::detached_offset;
+    };
+
+    // Doubly linked list with the interface of list for elements that live in one
+    // arena of at most 4 GiB starting at arena_base. Lists spliced into each other
+    // must share the arena. Moving the list does not touch its elements.
+    template<typename T, typename Tag = default_tag>
+    struct compact_list {
+        typedef compact_list_iterator<T, Tag> iterator;
+        typedef compact_list_iterator<const T, Tag> const_iterator;
+        using hook_t = compact_list_element<Tag>;
+
+        static_assert(std::is_convertible_v<T &, hook_t &>,
+                      "value type is not convertible to compact_list_element");
+
+        explicit compact_list(void const *arena_base) noexcept
+                : base(static_cast<char *>(const_cast<void *>(arena_base))) {
+            make_empty_head();
+        }
+
+        compact_list(compact_list const &) = delete;
+
+        compact_list(compact_list &&other) noexcept: base(other.base), head(other.head) {
+            other.make_empty_head();
+        }
+
+        ~compact_list() {
+            clear();
+        }
+
+        compact_list &operator=(compact_list const &) = delete;
+
+        compact_list &operator=(compact_list &&other) noexcept {
+            if (this != &other) {
+                clear();
+                base = other.base;
+                head = other.head;
+                other.make_empty_head();
+            }
+            return *this;
+        }
+
+        void clear() noexcept {
+            std::uint32_t current = head.next;
+            while (current != hook_t::head_offset) {
+                hook_t *element = hook_at(current);
+                current = element->next;
+                element->next = element->prev = hook_t::detached_offset;
+            }
+            make_empty_head();
+        }
+
+        void push_back(T &el) noexcept {
+            insert(end(), el);
+        }
+
+        void pop_back() noexcept {
+            erase(std::prev(end()));
+        }
+
+        T &back() noexcept {
+            return *std::prev(end());
+        }
+
+        T const &back() const noexcept {
+            return *std::prev(end());
+        }
+
+        void push_front(T &el) noexcept {
+            insert(begin(), el);
+        }
+
+        void pop_front() noexcept {
+            erase(begin());
+        }
+
+        T &front() noexcept {
+            return *begin();
+        }
+
+        T const &front() const noexcept {
+            return *begin();
+        }
+
+        bool empty() const noexcept {
+            return head.next == hook_t::head_offset;
+        }
+
+        iterator begin() noexcept {
+            return iterator(this, head.next);
+        }
+
+        const_iterator begin() const noexcept {
+            return const_iterator(this, head.next);
+        }
+
+        iterator end() noexcept {
+            return iterator(this, hook_t::head_offset);
+        }
+
+        const_iterator end() const noexcept {
+            return const_iterator(this, hook_t::head_offset);
+        }
+
+        iterator insert(const_iterator pos, T &el) noexcept {
+            hook_t &element = el;
+            std::uint32_t offset = offset_of(element);
+            hook_t *next_element = hook_at(pos.offset);
+            element.prev = next_element->prev;
+            element.next = pos.offset;
+            hook_at(element.prev)->next = offset;
+            next_element->prev = offset;
+            return iterator(this, offset);
+        }
+
+        iterator erase(const_iterator pos) noexcept {
+            hook_t *element = hook_at(pos.offset);
+            std::uint32_t next = element->next;
+            hook_at(element->prev)->next = next;
+            hook_at(next)->prev = element->prev;
+            element->next = element->prev = hook_t::detached_offset;
+            return iterator(this, next);
+        }
+
+        void splice(const_iterator pos, compact_list &other, const_iterator first, const_iterator last) noexcept {
+            assert(base == other.base);
+            if (first == last)
+                return;
+
+            hook_t *pos_element = hook_at(pos.offset);
+            hook_t *first_element = other.hook_at(first.offset);
+            hook_t *last_element = other.hook_at(last.offset);
+            std::uint32_t pos_prev = pos_element->prev;
+            std::uint32_t first_prev = first_element->prev;
+            std::uint32_t last_prev = last_element->prev;
+
+            hook_at(pos_prev)->next = first.offset;
+            other.hook_at(first_prev)->next = last.offset;
+            other.hook_at(last_prev)->next = pos.offset;
+            pos_element->prev = last_prev;
+            last_element->prev = first_prev;
+            first_element->prev = pos_prev;
+        }
+
+    private:
+        hook_t *hook_at(std::uint32_t offset) const noexcept {
+            if (offset == hook_t::head_offset) {
+                return const_cast<hook_t *>(&head);
+            }
+            return reinterpret_cast<hook_t *>(base + offset);
+        }
+
+        std::uint32_t offset_of(hook_t &element) const noexcept {
+            std::ptrdiff_t offset = reinterpret_cast<char *>(&element) - base;
+            assert(offset >= 0 && offset < static_cast<std::ptrdiff_t>(hook_t::detached_offset));
+            return static_cast<std::uint32_t>(offset);
+        }
+
+        void make_empty_head() noexcept {
+            head.next = head.prev = hook_t::head_offset;
+        }
+
+        char *base;
+        hook_t head;
+
+        friend struct compact_list_iterator<T, Tag>;
+        friend struct compact_list_iterator<const T, Tag>;
+    };
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "compact_list.h"
+#include "intrusive_list.h"
+#include "test_utils.h"
+#include <vector>
+
+namespace {
+    struct compact_node : intrusive::compact_list_element<> {
+        explicit compact_node(int value)
+                : value(value) {}
+
+        int value;
+    };
+
+    struct arena {
+        explicit arena(int n) {
+            nodes.reserve(n);
+            for (int i = 0; i < n; ++i) {
+                nodes.emplace_back(i + 1);
+            }
+        }
+
+        compact_node &operator[](int value) {
+            return nodes[value - 1];
+        }
+
+        void const *base() const {
+            return nodes.data();
+        }
+
+        std::vector<compact_node> nodes;
+    };
+
+    using compact_list = intrusive::compact_list<compact_node>;
+}
+
+TEST(compact_list_testing, hook_size) {
+    EXPECT_EQ(8, sizeof(intrusive::compact_list_element<>));
+    EXPECT_LT(sizeof(intrusive::compact_list_element<>), sizeof(intrusive::list_element<>));
+}
+
+TEST(compact_list_testing, push_pop) {
+    arena a(4);
+    compact_list list(a.base());
+    EXPECT_TRUE(list.empty());
+    list.push_back(a[2]);
+    list.push_back(a[3]);
+    list.push_front(a[1]);
+    list.push_back(a[4]);
+    expect_eq(list, {1, 2, 3, 4});
+    EXPECT_EQ(1, list.front().value);
+    EXPECT_EQ(4, std::as_const(list).back().value);
+    list.pop_front();
+    list.pop_back();
+    expect_eq(list, {2, 3});
+    EXPECT_FALSE(a[1].is_linked());
+    EXPECT_TRUE(a[2].is_linked());
+}
+
+TEST(compact_list_testing, first_element_of_arena) {
+    arena a(2);
+    compact_list list(a.base());
+    list.push_back(a[1]);
+    list.push_back(a[2]);
+    expect_eq(list, {1, 2});
+    list.erase(list.begin());
+    expect_eq(list, {2});
+}
+
+TEST(compact_list_testing, insert_erase) {
+    arena a(4);
+    compact_list list(a.base());
+    mass_push_back(list, a[1], a[3]);
+    auto it = list.insert(std::next(list.begin()), a[2]);
+    EXPECT_EQ(2, it->value);
+    list.insert(list.end(), a[4]);
+    expect_eq(list, {1, 2, 3, 4});
+    it = list.erase(it);
+    EXPECT_EQ(3, it->value);
+    expect_eq(list, {1, 3, 4});
+    EXPECT_TRUE(list.erase(std::prev(list.end())) == list.end());
+    expect_eq(list, {1, 3});
+}
+
+TEST(compact_list_testing, const_iterators) {
+    arena a(2);
+    compact_list list(a.base());
+    mass_push_back(list, a[1], a[2]);
+    compact_list::const_iterator it = list.begin();
+    EXPECT_EQ(1, it->value);
+    ++it;
+    EXPECT_EQ(2, it->value);
+    EXPECT_TRUE(++it == std::as_const(list).end());
+}
+
+TEST(compact_list_testing, splice_between_lists) {
+    arena a(8);
+    compact_list c1(a.base()), c2(a.base());
+    mass_push_back(c1, a[1], a[2], a[3], a[4]);
+    mass_push_back(c2, a[5], a[6], a[7], a[8]);
+    c1.splice(std::next(c1.begin(), 2), c2, std::next(c2.begin()), std::next(c2.begin(), 3));
+    expect_eq(c1, {1, 2, 6, 7, 3, 4});
+    expect_eq(c2, {5, 8});
+    c1.splice(c1.end(), c2, c2.begin(), c2.end());
+    expect_eq(c1, {1, 2, 6, 7, 3, 4, 5, 8});
+    EXPECT_TRUE(c2.empty());
+    c2.splice(c2.end(), c1, c1.begin(), c1.end());
+    expect_eq(c2, {1, 2, 6, 7, 3, 4, 5, 8});
+    EXPECT_TRUE(c1.empty());
+}
+
+TEST(compact_list_testing, splice_self) {
+    arena a(5);
+    compact_list c1(a.base());
+    mass_push_back(c1, a[1], a[2], a[3], a[4], a[5]);
+    c1.splice(std::next(c1.begin()), c1, std::next(c1.begin(), 2), std::prev(c1.end()));
+    expect_eq(c1, {1, 3, 4, 2, 5});
+}
+
+TEST(compact_list_testing, move) {
+    arena a(3);
+    compact_list c1(a.base());
+    mass_push_back(c1, a[1], a[2], a[3]);
+    compact_list c2 = std::move(c1);
+    EXPECT_TRUE(c1.empty());
+    expect_eq(c2, {1, 2, 3});
+    c1 = std::move(c2);
+    expect_eq(c1, {1, 2, 3});
+    EXPECT_TRUE(c2.empty());
+}
+
+TEST(compact_list_testing, clear) {
+    arena a(3);
+    compact_list c1(a.base());
+    mass_push_back(c1, a[1], a[2], a[3]);
+    c1.clear();
+    EXPECT_TRUE(c1.empty());
+    EXPECT_FALSE(a[2].is_linked());
+    mass_push_back(c1, a[3], a[1]);
+    expect_eq(c1, {3, 1});
+}
+
+TEST(compact_list_testing, multiple_tags) {
+    struct multi : intrusive::compact_list_element<struct tag_x>, intrusive::compact_list_element<struct tag_y> {
+        explicit multi(int value) : value(value) {}
+
+        int value;
+    };
+    std::vector<multi> nodes{multi(1), multi(2), multi(3)};
+    intrusive::compact_list<multi, tag_x> list_x(nodes.data());
+    intrusive::compact_list<multi, tag_y> list_y(nodes.data());
+    mass_push_back(list_x, nodes[0], nodes[1], nodes[2]);
+    mass_push_back(list_y, nodes[2], nodes[1], nodes[0]);
+    expect_eq(list_x, {1, 2, 3});
+    expect_eq(list_y, {3, 2, 1});
+}
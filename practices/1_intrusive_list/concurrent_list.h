@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+
+namespace intrusive {
+
+    struct default_tag;
+
+    namespace details {
+        struct spinlock {
+            void lock() noexcept {
+                for (unsigned spins = 0; !try_lock(); ++spins) {
+                    while (locked.load(std::memory_order_relaxed)) {
+                        if (++spins % 64 == 0) {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            }
+
+            bool try_lock() noexcept {
+                return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+            }
+
+            void unlock() noexcept {
+                locked.store(false, std::memory_order_release);
+            }
+
+        private:
+            std::atomic<bool> locked{false};
+        };
+    }
+
+    template<typename T, typename Tag>
+    struct concurrent_list;
+
+    // Hook of concurrent_list with an embedded spinlock guarding its own links.
+    // Any thread may unlink() an element at any time, including while other threads
+    // iterate over the list. The hook unlinks itself on destruction, but a type that
+    // may be visited concurrently must call unlink() in its own destructor, before
+    // its members are destroyed.
+    template<typename Tag = default_tag>
+    struct concurrent_list_element {
+
+        concurrent_list_element() = default;
+
+        concurrent_list_element(concurrent_list_element const &) = delete;
+
+        concurrent_list_element &operator=(concurrent_list_element const &) = delete;
+
+        ~concurrent_list_element() {
+            unlink();
+        }
+
+        bool is_linked() const noexcept {
+            lock.lock();
+            bool result = prev != nullptr;
+            lock.unlock();
+            return result;
+        }
+
+        // Locks are taken in list order; the only backward step (to prev) uses
+        // try_lock and starts over on failure, so lock waits cannot form a cycle.
+        void unlink() noexcept {
+            concurrent_list_element *p;
+            for (;;) {
+                lock.lock();
+                p = prev;
+                if (p == nullptr) {
+                    lock.unlock();
+                    return;
+                }
+                if (p->lock.try_lock())
+                    break;
+                lock.unlock();
+                std::this_thread::yield();
+            }
+            concurrent_list_element *n = next;
+            n->lock.lock();
+            p->next = n;
+            n->prev = p;
+            next = prev = nullptr;
+            n->lock.unlock();
+            p->lock.unlock();
+            lock.unlock();
+        }
+
+    private:
+        // every field is read and written only under the lock of its own element
+        concurrent_list_element *next = nullptr;
+        concurrent_list_element *prev = nullptr;
+        mutable details::spinlock lock;
+
+        template<typename T, typename ListTag>
+        friend struct concurrent_list;
+    };
+
+    // Doubly linked intrusive list that supports concurrent insertion, unlinking and
+    // iteration with hand-over-hand locking of the embedded per-element spinlocks.
+    // Iteration keeps the visited element locked, so it cannot be unlinked meanwhile.
+    template<typename T, typename Tag = default_tag>
+    struct concurrent_list {
+        using hook_t = concurrent_list_element<Tag>;
+
+        static_assert(std::is_convertible_v<T &, hook_t &>,
+                      "value type is not convertible to concurrent_list_element");
+
+        concurrent_list() noexcept {
+            head.next = &tail;
+            tail.prev = &head;
+        }
+
+        concurrent_list(concurrent_list const &) = delete;
+
+        concurrent_list &operator=(concurrent_list const &) = delete;
+
+        // No other thread may use the list while it is destroyed.
+        ~concurrent_list() {
+            clear();
+            head.next = tail.prev = nullptr;
+        }
+
+        void push_back(T &el) noexcept {
+            hook_t &element = el;
+            hook_t *p;
+            for (;;) {
+                tail.lock.lock();
+                p = tail.prev;
+                if (p->lock.try_lock())
+                    break;
+                tail.lock.unlock();
+                std::this_thread::yield();
+            }
+            element.prev = p;
+            element.next = &tail;
+            p->next = &element;
+            tail.prev = &element;
+            p->lock.unlock();
+            tail.lock.unlock();
+        }
+
+        void push_front(T &el) noexcept {
+            hook_t &element = el;
+            head.lock.lock();
+            hook_t *n = head.next;
+            n->lock.lock();
+            element.prev = &head;
+            element.next = n;
+            n->prev = &element;
+            head.next = &element;
+            n->lock.unlock();
+            head.lock.unlock();
+        }
+
+        // Unlinks the first element and returns it, or nullptr if the list is empty.
+        T *pop_front() noexcept {
+            head.lock.lock();
+            hook_t *first = head.next;
+            if (first == &tail) {
+                head.lock.unlock();
+                return nullptr;
+            }
+            first->lock.lock();
+            hook_t *second = first->next;
+            second->lock.lock();
+            head.next = second;
+            second->prev = &head;
+            first->next = first->prev = nullptr;
+            second->lock.unlock();
+            first->lock.unlock();
+            head.lock.unlock();
+            return static_cast<T *>(first);
+        }
+
+        bool empty() const noexcept {
+            head.lock.lock();
+            bool result = head.next == &tail;
+            head.lock.unlock();
+            return result;
+        }
+
+        void clear() noexcept {
+            while (pop_front() != nullptr) {}
+        }
+
+        // Calls f for every element from front to back. The element passed to f is locked:
+        // f must not insert or unlink anything adjacent to it, including itself.
+        template<typename F>
+        void for_each(F f) {
+            hook_t *current = &head;
+            current->lock.lock();
+            for (;;) {
+                hook_t *next = current->next;
+                if (next == &tail) {
+                    current->lock.unlock();
+                    return;
+                }
+                next->lock.lock();
+                current->lock.unlock();
+                current = next;
+                try {
+                    f(static_cast<T &>(*current));
+                } catch (...) {
+                    current->lock.unlock();
+                    throw;
+                }
+            }
+        }
+
+        std::size_t size() const noexcept {
+            std::size_t result = 0;
+            const_cast<concurrent_list *>(this)->for_each([&result](T &) { ++result; });
+            return result;
+        }
+
+    private:
+        hook_t head;
+        hook_t tail;
+    };
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "concurrent_list.h"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct session : intrusive::concurrent_list_element<> {
+        explicit session(int value)
+                : value(value) {}
+
+        ~session() {
+            unlink();
+            value = -1;
+        }
+
+        int value;
+    };
+
+    using session_list = intrusive::concurrent_list<session>;
+
+    std::vector<int> values(session_list &list) {
+        std::vector<int> result;
+        list.for_each([&result](session &s) { result.push_back(s.value); });
+        return result;
+    }
+}
+
+TEST(concurrent_list_testing, push_and_iterate) {
+    session_list list;
+    session a(1), b(2), c(3);
+    EXPECT_TRUE(list.empty());
+    list.push_back(b);
+    list.push_back(c);
+    list.push_front(a);
+    EXPECT_FALSE(list.empty());
+    EXPECT_EQ(3, list.size());
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), values(list));
+}
+
+TEST(concurrent_list_testing, unlink) {
+    session_list list;
+    session a(1), b(2), c(3);
+    list.push_back(a);
+    list.push_back(b);
+    list.push_back(c);
+    b.unlink();
+    EXPECT_FALSE(b.is_linked());
+    EXPECT_TRUE(a.is_linked());
+    EXPECT_EQ((std::vector<int>{1, 3}), values(list));
+    b.unlink();
+    a.unlink();
+    c.unlink();
+    EXPECT_TRUE(list.empty());
+}
+
+TEST(concurrent_list_testing, destructor_unlinks) {
+    session_list list;
+    session a(1);
+    {
+        session b(2);
+        list.push_back(a);
+        list.push_back(b);
+    }
+    EXPECT_EQ((std::vector<int>{1}), values(list));
+}
+
+TEST(concurrent_list_testing, pop_front_and_clear) {
+    session_list list;
+    session a(1), b(2), c(3);
+    EXPECT_EQ(nullptr, list.pop_front());
+    list.push_back(a);
+    list.push_back(b);
+    list.push_back(c);
+    EXPECT_EQ(&a, list.pop_front());
+    EXPECT_FALSE(a.is_linked());
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_FALSE(c.is_linked());
+}
+
+TEST(concurrent_list_testing, exception_in_for_each) {
+    session_list list;
+    session a(1), b(2);
+    list.push_back(a);
+    list.push_back(b);
+    EXPECT_THROW(list.for_each([](session &s) {
+        if (s.value == 1)
+            throw std::runtime_error("visit");
+    }), std::runtime_error);
+    a.unlink();
+    EXPECT_EQ((std::vector<int>{2}), values(list));
+}
+
+TEST(concurrent_list_testing, mixed_workload_stress) {
+    session_list list;
+    std::size_t const threads_count = 4;
+    std::size_t const sessions_per_thread = 64;
+    std::atomic<bool> failed{false};
+    std::atomic<std::size_t> visited{0};
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t));
+            std::vector<std::unique_ptr<session>> own(sessions_per_thread);
+            for (int step = 0; step < 3000; ++step) {
+                auto &s = own[rng() % sessions_per_thread];
+                switch (rng() % 5) {
+                    case 0:
+                        if (!s) {
+                            s = std::make_unique<session>(static_cast<int>(t));
+                            list.push_back(*s);
+                        }
+                        break;
+                    case 1:
+                        if (!s) {
+                            s = std::make_unique<session>(static_cast<int>(t));
+                            list.push_front(*s);
+                        }
+                        break;
+                    case 2:
+                        if (s) {
+                            s->unlink();
+                            s.reset();
+                        }
+                        break;
+                    case 3:
+                        s.reset();
+                        break;
+                    default:
+                        list.for_each([&](session &visit) {
+                            if (visit.value < 0 || visit.value >= static_cast<int>(threads_count)) {
+                                failed = true;
+                            }
+                            ++visited;
+                        });
+                }
+            }
+            for (auto &s : own) {
+                s.reset();
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(failed);
+    EXPECT_GT(visited.load(), 0);
+    EXPECT_TRUE(list.empty());
+}
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace intrusive {
+
+    struct default_tag;
+
+    // Hook of a singly linked list: a single pointer, no vptr and no auto-unlink,
+    // as an element cannot unlink itself without its predecessor. An element must
+    // be removed from its list before it is destroyed.
+    template<typename Tag = default_tag>
+    struct forward_list_element {
+
+        forward_list_element<Tag> *next = nullptr;
+
+        forward_list_element<Tag>() = default;
+
+        forward_list_element(forward_list_element const &) = delete;
+
+        forward_list_element &operator=(forward_list_element const &) = delete;
+
+        bool is_linked() const noexcept {
+            return next != nullptr;
+        }
+    };
+
+    namespace details {
+        // The last element of every forward_list points here, so that end() needs no
+        // list and a moved list does not have to relink its last element.
+        template<typename Tag>
+        struct forward_list_end {
+            static inline forward_list_element<Tag> element;
+        };
+
+        template<typename Tag, bool CacheLast>
+        struct last_cache {
+            void set_last(forward_list_element<Tag> *) noexcept {}
+        };
+
+        template<typename Tag>
+        struct last_cache<Tag, true> {
+            void set_last(forward_list_element<Tag> *element) noexcept {
+                last = element;
+            }
+
+            forward_list_element<Tag> *last = nullptr;
+        };
+    }
+
+    template<typename T, typename Tag>
+    struct forward_list_iterator {
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *;
+        using reference = T &;
+        using base = std::conditional_t<std::is_const_v<T>,
+                forward_list_element<Tag> const, forward_list_element<Tag>>;
+
+        forward_list_iterator() = default;
+
+        template<typename V>
+        forward_list_iterator(forward_list_iterator<V, Tag> other, std::enable_if_t<
+                std::is_same_v<V, std::remove_const_t<T>> && std::is_const_v<T>> * = nullptr) noexcept
+                : current(other.current) {}
+
+        T &operator*() const noexcept {
+            return static_cast<T &>(*current);
+        }
+
+        T *operator->() const noexcept {
+            return &**this;
+        }
+
+        forward_list_iterator &operator++() & noexcept {
+            current = current->next;
+            return *this;
+        }
+
+        forward_list_iterator operator++(int) & noexcept {
+            forward_list_iterator temp = *this;
+            current = current->next;
+            return temp;
+        }
+
+        bool operator==(forward_list_iterator const &rhs) const & noexcept {
+            return current == rhs.current;
+        }
+
+        bool operator!=(forward_list_iterator const &rhs) const & noexcept {
+            return current != rhs.current;
+        }
+
+        explicit forward_list_iterator(base *current) noexcept: current(current) {}
+
+        base *current = nullptr;
+    };
+
+    // Singly linked intrusive list. Everything but size() is O(1); with CacheLast the list
+    // also keeps a pointer to its last element for push_back(), back() and whole-list splice.
+    template<typename T, typename Tag = default_tag, bool CacheLast = false>
+    struct forward_list : private details::last_cache<Tag, CacheLast> {
+        typedef forward_list_iterator<T, Tag> iterator;
+        typedef forward_list_iterator<const T, Tag> const_iterator;
+        using hook_t = forward_list_element<Tag>;
+        static constexpr bool cache_last = CacheLast;
+
+        static_assert(std::is_convertible_v<T &, hook_t &>,
+                      "value type is not convertible to forward_list_element");
+
+        forward_list() noexcept {
+            make_empty_head();
+        }
+
+        forward_list(forward_list const &) = delete;
+
+        forward_list(forward_list &&other) noexcept {
+            take_head_from(other);
+        }
+
+        ~forward_list() {
+            clear();
+        }
+
+        forward_list &operator=(forward_list const &) = delete;
+
+        forward_list &operator=(forward_list &&other) noexcept {
+            if (this != &other) {
+                clear();
+                take_head_from(other);
+            }
+            return *this;
+        }
+
+        void swap(forward_list &other) noexcept {
+            forward_list temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+
+        void clear() noexcept {
+            hook_t *current = head.next;
+            while (current != end_element()) {
+                hook_t *next = current->next;
+                current->next = nullptr;
+                current = next;
+            }
+            make_empty_head();
+        }
+
+        std::size_t size() const noexcept {
+            return std::distance(begin(), end());
+        }
+
+        bool empty() const noexcept {
+            return head.next == end_element();
+        }
+
+        void push_front(T &el) noexcept {
+            insert_after(before_begin(), el);
+        }
+
+        void pop_front() noexcept {
+            erase_after(before_begin());
+        }
+
+        T &front() noexcept {
+            return static_cast<T &>(*head.next);
+        }
+
+        T const &front() const noexcept {
+            return static_cast<T const &>(*head.next);
+        }
+
+        void push_back(T &el) noexcept {
+            static_assert(CacheLast, "push_back() requires CacheLast");
+            insert_after(const_iterator(last_element()), el);
+        }
+
+        T &back() noexcept {
+            static_assert(CacheLast, "back() requires CacheLast");
+            return static_cast<T &>(*last_element());
+        }
+
+        T const &back() const noexcept {
+            static_assert(CacheLast, "back() requires CacheLast");
+            return static_cast<T const &>(*last_element());
+        }
+
+        // The position before the first element, for insert_after(), erase_after() and splice_after().
+        iterator before_begin() noexcept {
+            return iterator(&head);
+        }
+
+        const_iterator before_begin() const noexcept {
+            return const_iterator(&head);
+        }
+
+        iterator begin() noexcept {
+            return iterator(head.next);
+        }
+
+        const_iterator begin() const noexcept {
+            return const_iterator(head.next);
+        }
+
+        iterator end() noexcept {
+            return iterator(end_element());
+        }
+
+        const_iterator end() const noexcept {
+            return const_iterator(end_element());
+        }
+
+        iterator insert_after(const_iterator pos, T &el) noexcept {
+            hook_t &element = el;
+            hook_t *prev = mutable_element(pos);
+            element.next = prev->next;
+            prev->next = &element;
+            if constexpr (CacheLast) {
+                if (prev == last_element()) {
+                    this->set_last(&element);
+                }
+            }
+            return iterator(&element);
+        }
+
+        // Unlinks the element after pos and returns the iterator to the element that followed it.
+        iterator erase_after(const_iterator pos) noexcept {
+            hook_t *prev = mutable_element(pos);
+            hook_t *element = prev->next;
+            prev->next = element->next;
+            element->next = nullptr;
+            if constexpr (CacheLast) {
+                if (element == last_element()) {
+                    this->set_last(prev);
+                }
+            }
+            return iterator(prev->next);
+        }
+
+        // Unlinks the elements in (first, last).
+        iterator erase_after(const_iterator first, const_iterator last) noexcept {
+            hook_t *prev = mutable_element(first);
+            hook_t *stop = mutable_element(last);
+            hook_t *current = prev->next;
+            while (current != stop) {
+                hook_t *next = current->next;
+                current->next = nullptr;
+                current = next;
+            }
+            prev->next = stop;
+            if constexpr (CacheLast) {
+                if (stop == end_element()) {
+                    this->set_last(prev);
+                }
+            }
+            return iterator(stop);
+        }
+
+        // Moves the elements in (before_first, before_last] of other after pos, which must not be among them.
+        // Unlike std::forward_list the range includes before_last, so no walk is needed.
+        void splice_after(const_iterator pos, forward_list &other,
+                          const_iterator before_first, const_iterator before_last) noexcept {
+            if (before_first == before_last || pos == before_first)
+                return;
+
+            hook_t *prev = mutable_element(pos);
+            hook_t *first_prev = mutable_element(before_first);
+            hook_t *last = mutable_element(before_last);
+            hook_t *first = first_prev->next;
+            hook_t *next = prev->next;
+
+            if constexpr (CacheLast) {
+                if (last == other.last_element()) {
+                    other.set_last(first_prev);
+                }
+                if (prev == last_element()) {
+                    this->set_last(last);
+                }
+            }
+            first_prev->next = last->next;
+            prev->next = first;
+            last->next = next;
+        }
+
+        // Moves all elements of other after pos: O(1) with CacheLast, linear in other.size() otherwise.
+        void splice_after(const_iterator pos, forward_list &other) noexcept {
+            if (&other == this || other.empty())
+                return;
+            if constexpr (CacheLast) {
+                splice_after(pos, other, other.before_begin(), const_iterator(other.last_element()));
+            } else {
+                const_iterator before_last = other.before_begin();
+                for (const_iterator it = other.begin(); it != other.end(); ++it) {
+                    before_last = it;
+                }
+                splice_after(pos, other, other.before_begin(), before_last);
+            }
+        }
+
+    private:
+        static hook_t *end_element() noexcept {
+            return &details::forward_list_end<Tag>::element;
+        }
+
+        static hook_t *mutable_element(const_iterator pos) noexcept {
+            return const_cast<hook_t *>(pos.current);
+        }
+
+        hook_t *last_element() const noexcept {
+            return this->last;
+        }
+
+        void take_head_from(forward_list &other) noexcept {
+            if (other.empty()) {
+                make_empty_head();
+                return;
+            }
+            head.next = other.head.next;
+            if constexpr (CacheLast) {
+                this->set_last(other.last);
+            }
+            other.make_empty_head();
+        }
+
+        void make_empty_head() noexcept {
+            head.next = end_element();
+            this->set_last(&head);
+        }
+
+        hook_t head;
+    };
+}
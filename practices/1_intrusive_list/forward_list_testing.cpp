@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+#include "forward_list.h"
+#include "intrusive_list.h"
+#include <deque>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct node : intrusive::forward_list_element<> {
+        explicit node(int value)
+                : value(value) {}
+
+        int value;
+    };
+
+    struct tag_a;
+    struct tag_b;
+
+    struct multi_node : intrusive::forward_list_element<tag_a>, intrusive::forward_list_element<tag_b> {
+        explicit multi_node(int value)
+                : value(value) {}
+
+        int value;
+    };
+
+    using forward_list = intrusive::forward_list<node>;
+    using queue = intrusive::forward_list<node, intrusive::default_tag, true>;
+
+    template<typename C>
+    void expect_values(C const &cont, std::initializer_list<int> values) {
+        std::vector<int> actual;
+        for (auto const &element : cont) {
+            actual.push_back(element.value);
+        }
+        EXPECT_EQ(std::vector<int>(values), actual);
+        EXPECT_EQ(values.size(), cont.size());
+    }
+}
+
+TEST(forward_list_testing, hook_size) {
+    EXPECT_EQ(sizeof(void *), sizeof(intrusive::forward_list_element<>));
+    EXPECT_LT(sizeof(intrusive::forward_list_element<>), sizeof(intrusive::list_element<>));
+    EXPECT_FALSE(std::is_polymorphic_v<intrusive::forward_list_element<>>);
+}
+
+TEST(forward_list_testing, push_pop_front) {
+    node a(1), b(2), c(3);
+    forward_list list;
+    EXPECT_TRUE(list.empty());
+    list.push_front(c);
+    list.push_front(b);
+    list.push_front(a);
+    expect_values(list, {1, 2, 3});
+    EXPECT_EQ(1, list.front().value);
+    EXPECT_TRUE(c.is_linked());
+    list.pop_front();
+    expect_values(list, {2, 3});
+    EXPECT_FALSE(a.is_linked());
+    list.pop_front();
+    list.pop_front();
+    EXPECT_TRUE(list.empty());
+    EXPECT_FALSE(c.is_linked());
+}
+
+TEST(forward_list_testing, insert_after) {
+    node a(1), b(2), c(3), d(4);
+    forward_list list;
+    auto it = list.insert_after(list.before_begin(), a);
+    EXPECT_EQ(&a, &*it);
+    it = list.insert_after(it, c);
+    list.insert_after(list.begin(), b);
+    list.insert_after(it, d);
+    expect_values(list, {1, 2, 3, 4});
+}
+
+TEST(forward_list_testing, erase_after) {
+    node a(1), b(2), c(3), d(4);
+    forward_list list;
+    list.push_front(d);
+    list.push_front(c);
+    list.push_front(b);
+    list.push_front(a);
+    auto it = list.erase_after(list.begin());
+    EXPECT_EQ(&c, &*it);
+    EXPECT_FALSE(b.is_linked());
+    it = list.erase_after(it);
+    EXPECT_EQ(list.end(), it);
+    expect_values(list, {1, 3});
+    list.erase_after(list.before_begin());
+    expect_values(list, {3});
+}
+
+TEST(forward_list_testing, erase_after_range) {
+    node a(1), b(2), c(3), d(4);
+    forward_list list;
+    list.push_front(d);
+    list.push_front(c);
+    list.push_front(b);
+    list.push_front(a);
+    auto it = list.erase_after(list.begin(), std::next(list.begin(), 3));
+    EXPECT_EQ(&d, &*it);
+    EXPECT_FALSE(b.is_linked());
+    EXPECT_FALSE(c.is_linked());
+    expect_values(list, {1, 4});
+    list.erase_after(list.before_begin(), list.end());
+    EXPECT_TRUE(list.empty());
+    EXPECT_FALSE(d.is_linked());
+}
+
+TEST(forward_list_testing, splice_after) {
+    std::deque<node> nodes;
+    for (int i = 1; i <= 6; ++i) {
+        nodes.emplace_back(i);
+    }
+    forward_list a, b;
+    for (int i = 2; i >= 0; --i) {
+        a.push_front(nodes[i]);
+    }
+    for (int i = 5; i >= 3; --i) {
+        b.push_front(nodes[i]);
+    }
+    // moves 5, 6 after 1
+    a.splice_after(a.begin(), b, b.begin(), std::next(b.begin(), 2));
+    expect_values(a, {1, 5, 6, 2, 3});
+    expect_values(b, {4});
+    // moves 1, 5 to the front of b
+    b.splice_after(b.before_begin(), a, a.before_begin(), std::next(a.begin()));
+    expect_values(a, {6, 2, 3});
+    expect_values(b, {1, 5, 4});
+}
+
+TEST(forward_list_testing, splice_after_within_list) {
+    std::deque<node> nodes;
+    for (int i = 1; i <= 5; ++i) {
+        nodes.emplace_back(i);
+    }
+    forward_list list;
+    for (int i = 4; i >= 0; --i) {
+        list.push_front(nodes[i]);
+    }
+    list.splice_after(std::next(list.begin(), 3), list, list.before_begin(), std::next(list.begin()));
+    expect_values(list, {3, 4, 1, 2, 5});
+    list.splice_after(list.before_begin(), list, list.before_begin(), list.begin());
+    expect_values(list, {3, 4, 1, 2, 5});
+}
+
+TEST(forward_list_testing, splice_whole_list) {
+    node a(1), b(2), c(3), d(4);
+    forward_list x, y;
+    x.push_front(b);
+    x.push_front(a);
+    y.push_front(d);
+    y.push_front(c);
+    x.splice_after(x.begin(), y);
+    expect_values(x, {1, 3, 4, 2});
+    EXPECT_TRUE(y.empty());
+    x.splice_after(x.begin(), y);
+    expect_values(x, {1, 3, 4, 2});
+}
+
+TEST(forward_list_testing, queue_push_back) {
+    node a(1), b(2), c(3);
+    queue q;
+    q.push_back(a);
+    EXPECT_EQ(&a, &q.back());
+    q.push_back(b);
+    q.push_back(c);
+    expect_values(q, {1, 2, 3});
+    EXPECT_EQ(1, q.front().value);
+    EXPECT_EQ(3, q.back().value);
+    q.pop_front();
+    q.pop_front();
+    EXPECT_EQ(&c, &q.front());
+    EXPECT_EQ(&c, &q.back());
+    q.pop_front();
+    EXPECT_TRUE(q.empty());
+    q.push_back(b);
+    expect_values(q, {2});
+    EXPECT_EQ(&b, &q.back());
+}
+
+TEST(forward_list_testing, queue_keeps_last) {
+    node a(1), b(2), c(3), d(4), e(5);
+    queue q;
+    q.push_back(a);
+    q.push_back(b);
+    q.insert_after(std::next(q.begin()), c);
+    EXPECT_EQ(&c, &q.back());
+    q.erase_after(q.begin());
+    EXPECT_EQ(&c, &q.back());
+    q.erase_after(q.begin());
+    EXPECT_EQ(&a, &q.back());
+    q.push_back(b);
+    q.push_back(c);
+    q.erase_after(q.before_begin(), q.end());
+    EXPECT_TRUE(q.empty());
+    q.push_back(d);
+    q.push_back(e);
+    expect_values(q, {4, 5});
+    EXPECT_EQ(&e, &q.back());
+}
+
+TEST(forward_list_testing, queue_splice) {
+    node a(1), b(2), c(3), d(4), e(5), f(6);
+    queue x, y;
+    x.push_back(a);
+    x.push_back(b);
+    y.push_back(c);
+    y.push_back(d);
+    y.push_back(e);
+    // tail of y moves to the tail of x
+    x.splice_after(std::next(x.begin()), y, y.begin(), std::next(y.begin(), 2));
+    expect_values(x, {1, 2, 4, 5});
+    expect_values(y, {3});
+    EXPECT_EQ(&e, &x.back());
+    EXPECT_EQ(&c, &y.back());
+    // the whole x goes after the last element of y
+    y.splice_after(y.begin(), x);
+    expect_values(y, {3, 1, 2, 4, 5});
+    EXPECT_EQ(&e, &y.back());
+    EXPECT_TRUE(x.empty());
+    x.push_back(f);
+    EXPECT_EQ(&f, &x.front());
+    EXPECT_EQ(&f, &x.back());
+}
+
+TEST(forward_list_testing, move_and_swap) {
+    node a(1), b(2), c(3), d(4);
+    queue x;
+    x.push_back(a);
+    x.push_back(b);
+    queue y(std::move(x));
+    EXPECT_TRUE(x.empty());
+    expect_values(y, {1, 2});
+    EXPECT_EQ(&b, &y.back());
+    y.push_back(c);
+    expect_values(y, {1, 2, 3});
+    x.swap(y);
+    expect_values(x, {1, 2, 3});
+    EXPECT_TRUE(y.empty());
+    y = std::move(x);
+    expect_values(y, {1, 2, 3});
+    EXPECT_EQ(&c, &y.back());
+    x.push_back(d);
+    expect_values(x, {4});
+}
+
+TEST(forward_list_testing, clear_unlinks) {
+    node a(1), b(2);
+    {
+        forward_list list;
+        list.push_front(a);
+        list.push_front(b);
+        list.clear();
+        EXPECT_TRUE(list.empty());
+        EXPECT_FALSE(a.is_linked());
+        list.push_front(a);
+    }
+    EXPECT_FALSE(a.is_linked());
+    EXPECT_FALSE(b.is_linked());
+}
+
+TEST(forward_list_testing, multiple_tags) {
+    multi_node a(1), b(2);
+    intrusive::forward_list<multi_node, tag_a> list_a;
+    intrusive::forward_list<multi_node, tag_b, true> list_b;
+    list_a.push_front(b);
+    list_a.push_front(a);
+    list_b.push_back(b);
+    list_b.push_back(a);
+    expect_values(list_a, {1, 2});
+    expect_values(list_b, {2, 1});
+    list_a.pop_front();
+    expect_values(list_b, {2, 1});
+    list_b.clear();
+}
+
+TEST(forward_list_testing, const_iteration) {
+    node a(1), b(2);
+    forward_list list;
+    list.push_front(b);
+    list.push_front(a);
+    forward_list const &ref = list;
+    forward_list::const_iterator it = list.begin();
+    EXPECT_EQ(ref.begin(), it);
+    EXPECT_EQ(2, std::next(it)->value);
+    EXPECT_EQ(ref.end(), std::next(it, 2));
+    EXPECT_EQ(ref.begin(), std::next(ref.before_begin()));
+}
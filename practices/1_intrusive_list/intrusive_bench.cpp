@@ -0,0 +1,1072 @@
+#include "bench_utils.h"
+#include "compact_list.h"
+#include "concurrent_list.h"
+#include "forward_list.h"
+#include "intrusive_list.h"
+#include "object_pool.h"
+#include "parallel_sort.h"
+#include "skip_list.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+    struct bench_node : intrusive::list_element<> {
+        explicit bench_node(std::size_t value) : value(value) {}
+
+        std::size_t value;
+    };
+
+    using node_list = intrusive::list<bench_node>;
+
+    std::size_t const repeats = 5;
+
+    void link(node_list &list, std::vector<bench_node *> const &nodes, std::vector<std::size_t> const &order) {
+        for (std::size_t i : order) {
+            list.push_back(*nodes[i]);
+        }
+    }
+
+    void bench_clear(std::size_t n) {
+        for (bool shuffled : {false, true}) {
+            std::string layout = shuffled ? "shuffled" : "sequential";
+            std::vector<std::size_t> order = bench::link_order(n, shuffled);
+            std::vector<std::unique_ptr<bench_node>> storage;
+            std::vector<bench_node *> nodes;
+            for (std::size_t i = 0; i < n; ++i) {
+                storage.push_back(std::make_unique<bench_node>(i));
+                nodes.push_back(storage.back().get());
+            }
+            node_list list;
+
+            bench::report("clear/pop_front loop/" + layout, n, bench::measure_ns(
+                    repeats, [&] { link(list, nodes, order); },
+                    [&] {
+                        while (!list.empty()) {
+                            list.pop_front();
+                        }
+                    }));
+            bench::report("clear/clear()/" + layout, n, bench::measure_ns(
+                    repeats, [&] { link(list, nodes, order); },
+                    [&] { list.clear(); }));
+            bench::report("clear/detach_all()/" + layout, n, bench::measure_ns(
+                    repeats, [&] {
+                        for (bench_node *node : nodes) {
+                            node->unlink();
+                        }
+                        link(list, nodes, order);
+                    },
+                    [&] { list.detach_all(); }));
+            list.clear();
+            storage.clear();
+
+            std::vector<bench_node *> owned(n);
+            bench::report("dispose/pop_front + delete/" + layout, n, bench::measure_ns(
+                    repeats, [&] {
+                        for (std::size_t i = 0; i < n; ++i) {
+                            owned[i] = new bench_node(i);
+                        }
+                        link(list, owned, order);
+                    },
+                    [&] {
+                        while (!list.empty()) {
+                            bench_node &node = list.front();
+                            list.pop_front();
+                            delete &node;
+                        }
+                    }));
+            bench::report("dispose/dispose_all(delete)/" + layout, n, bench::measure_ns(
+                    repeats, [&] {
+                        for (std::size_t i = 0; i < n; ++i) {
+                            owned[i] = new bench_node(i);
+                        }
+                        link(list, owned, order);
+                    },
+                    [&] { list.dispose_all([](bench_node &node) { delete &node; }); }));
+        }
+    }
+
+    void bench_traversal(std::size_t n) {
+        std::size_t sum = 0;
+        auto add = [&sum](std::size_t value) {
+            sum += value * value;
+        };
+
+        std::vector<std::size_t> vector(n);
+        std::iota(vector.begin(), vector.end(), 0);
+        bench::report("traverse/std::vector", n, bench::measure_ns(
+                repeats, [] {},
+                [&] {
+                    for (std::size_t value : vector) {
+                        add(value);
+                    }
+                }));
+        bench::do_not_optimize(sum);
+
+        for (bool shuffled : {false, true}) {
+            std::string layout = shuffled ? "shuffled" : "sequential";
+            std::vector<std::size_t> order = bench::link_order(n, shuffled);
+
+            // nodes are allocated in memory order and then relinked in traversal order
+            std::list<std::pair<std::size_t, std::size_t>> std_list;
+            for (std::size_t i = 0; i < n; ++i) {
+                std_list.emplace_back(order[i], i);
+            }
+            std_list.sort();
+            bench::report("traverse/std::list/" + layout, n, bench::measure_ns(
+                    repeats, [] {},
+                    [&] {
+                        for (auto const &value : std_list) {
+                            add(value.second);
+                        }
+                    }));
+            bench::do_not_optimize(sum);
+            std_list.clear();
+
+            std::vector<bench_node> nodes;
+            nodes.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                nodes.emplace_back(i);
+            }
+            node_list list;
+            for (std::size_t i : order) {
+                list.push_back(nodes[i]);
+            }
+            bench::report("traverse/intrusive::list/" + layout, n, bench::measure_ns(
+                    repeats, [] {},
+                    [&] {
+                        for (bench_node const &node : list) {
+                            add(node.value);
+                        }
+                    }));
+            bench::do_not_optimize(sum);
+            for (std::size_t distance : {1, 2, 4, 8, 16}) {
+                std::string name = "traverse/for_each_prefetched(" + std::to_string(distance) + ")/" + layout;
+                bench::report(name, n, bench::measure_ns(
+                        repeats, [] {},
+                        [&] {
+                            intrusive::for_each_prefetched(list, [&](bench_node const &node) {
+                                add(node.value);
+                            }, distance);
+                        }));
+                bench::do_not_optimize(sum);
+            }
+            list.clear();
+        }
+    }
+
+    void bench_sort(std::size_t n) {
+        auto key_less = [](bench_node const &a, bench_node const &b) {
+            return a.value < b.value;
+        };
+        std::vector<std::size_t> keys = bench::link_order(n, true);
+
+        std::list<std::size_t> std_list;
+        bench::report("sort/std::list::sort", n, bench::measure_ns(
+                repeats, [&] { std_list.assign(keys.begin(), keys.end()); },
+                [&] { std_list.sort(); }));
+        std_list.clear();
+
+        std::vector<std::unique_ptr<bench_node>> storage;
+        std::vector<bench_node *> nodes;
+        for (std::size_t i = 0; i < n; ++i) {
+            storage.push_back(std::make_unique<bench_node>(keys[i]));
+            nodes.push_back(storage.back().get());
+        }
+        std::vector<std::size_t> order = bench::link_order(n, false);
+        node_list list;
+        auto relink = [&] {
+            list.clear();
+            link(list, nodes, order);
+        };
+
+        bench::report("sort/intrusive::list::sort", n, bench::measure_ns(
+                repeats, relink, [&] { list.sort(key_less); }));
+
+        std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::size_t> thread_counts;
+        for (std::size_t threads = 1; threads < max_threads; threads *= 2) {
+            thread_counts.push_back(threads);
+        }
+        thread_counts.push_back(max_threads);
+        for (std::size_t threads : thread_counts) {
+            std::string name = "sort/intrusive::parallel_sort/threads:" + std::to_string(threads);
+            bench::report(name, n, bench::measure_ns(
+                    repeats, relink, [&] { intrusive::parallel_sort(list, key_less, threads); }));
+        }
+        list.clear();
+    }
+
+    struct small_node : intrusive::list_element<> {
+        explicit small_node(std::uint32_t value) : value(value) {}
+
+        std::uint32_t value;
+    };
+
+    struct compact_node : intrusive::compact_list_element<> {
+        explicit compact_node(std::uint32_t value) : value(value) {}
+
+        std::uint32_t value;
+    };
+
+    template<typename Node, typename List>
+    void bench_list_throughput(char const *list_name, std::size_t n, std::vector<Node> &nodes, List &list) {
+        for (bool shuffled : {false, true}) {
+            std::string prefix = std::string("compact/") + list_name + "/";
+            std::string layout = shuffled ? "/shuffled" : "/sequential";
+            std::vector<std::size_t> order = bench::link_order(n, shuffled);
+
+            bench::report(prefix + "push_back" + layout, n, bench::measure_ns(
+                    repeats, [&] { list.clear(); },
+                    [&] {
+                        for (std::size_t i : order) {
+                            list.push_back(nodes[i]);
+                        }
+                    }));
+            bench::report(prefix + "iterate" + layout, n, bench::measure_ns(
+                    repeats, [] {},
+                    [&] {
+                        std::uint64_t sum = 0;
+                        for (Node const &node : list) {
+                            sum += node.value;
+                        }
+                        bench::do_not_optimize(sum);
+                    }));
+            bench::report(prefix + "erase every other" + layout, n, bench::measure_ns(
+                    repeats, [&] {
+                        list.clear();
+                        for (std::size_t i : order) {
+                            list.push_back(nodes[i]);
+                        }
+                    },
+                    [&] {
+                        for (auto it = list.begin(); it != list.end() && std::next(it) != list.end();) {
+                            it = std::next(list.erase(it));
+                        }
+                    }));
+            list.clear();
+        }
+    }
+
+    void bench_compact(std::size_t n) {
+        std::fprintf(bench::log(), "compact/hook bytes: list_element %zu, compact_list_element %zu\n",
+                     sizeof(intrusive::list_element<>), sizeof(intrusive::compact_list_element<>));
+        std::fprintf(bench::log(), "compact/node bytes with 4-byte payload: list %zu (%zu per cache line), "
+                     "compact_list %zu (%zu per cache line)\n",
+                     sizeof(small_node), 64 / sizeof(small_node), sizeof(compact_node), 64 / sizeof(compact_node));
+        std::fprintf(bench::log(), "compact/arena bytes for %zu nodes: list %zu, compact_list %zu\n",
+                     n, n * sizeof(small_node), n * sizeof(compact_node));
+
+        {
+            std::vector<small_node> nodes;
+            nodes.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                nodes.emplace_back(static_cast<std::uint32_t>(i));
+            }
+            intrusive::list<small_node> list;
+            bench_list_throughput("intrusive::list", n, nodes, list);
+        }
+        {
+            std::vector<compact_node> nodes;
+            nodes.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                nodes.emplace_back(static_cast<std::uint32_t>(i));
+            }
+            intrusive::compact_list<compact_node> list(nodes.data());
+            bench_list_throughput("intrusive::compact_list", n, nodes, list);
+        }
+    }
+
+    struct doubly_node : intrusive::list_element<> {
+        std::uint64_t value = 0;
+    };
+
+    struct singly_node : intrusive::forward_list_element<> {
+        std::uint64_t value = 0;
+    };
+
+    template<typename Node, typename List>
+    void bench_stack_and_queue(char const *list_name, std::size_t n) {
+        std::unique_ptr<Node[]> nodes(new Node[n]);
+        for (std::size_t i = 0; i < n; ++i) {
+            nodes[i].value = i;
+        }
+        List list;
+        for (bool shuffled : {false, true}) {
+            std::string prefix = std::string("forward/") + list_name + "/";
+            std::string layout = shuffled ? "/shuffled" : "/sequential";
+            std::vector<std::size_t> order = bench::link_order(n, shuffled);
+
+            bench::report(prefix + "push_front + pop_front" + layout, n, bench::measure_ns(
+                    repeats, [] {},
+                    [&] {
+                        for (std::size_t i : order) {
+                            list.push_front(nodes[i]);
+                        }
+                        while (!list.empty()) {
+                            list.pop_front();
+                        }
+                    }));
+            bench::report(prefix + "push_back + pop_front" + layout, n, bench::measure_ns(
+                    repeats, [] {},
+                    [&] {
+                        for (std::size_t i : order) {
+                            list.push_back(nodes[i]);
+                        }
+                        while (!list.empty()) {
+                            list.pop_front();
+                        }
+                    }));
+            for (std::size_t i : order) {
+                list.push_back(nodes[i]);
+            }
+            bench::report(prefix + "iterate" + layout, n, bench::measure_ns(
+                    repeats, [] {},
+                    [&] {
+                        std::uint64_t sum = 0;
+                        for (Node const &node : list) {
+                            sum += node.value;
+                        }
+                        bench::do_not_optimize(sum);
+                    }));
+            list.clear();
+        }
+    }
+
+    void bench_forward(std::size_t n) {
+        std::fprintf(bench::log(), "forward/hook bytes: list_element %zu, forward_list_element %zu\n",
+                     sizeof(intrusive::list_element<>), sizeof(intrusive::forward_list_element<>));
+        std::fprintf(bench::log(), "forward/node bytes with 8-byte payload: list %zu (%zu per cache line), "
+                     "forward_list %zu (%zu per cache line)\n",
+                     sizeof(doubly_node), 64 / sizeof(doubly_node), sizeof(singly_node), 64 / sizeof(singly_node));
+        std::fprintf(bench::log(), "forward/list head bytes: list %zu, forward_list %zu, forward_list with last %zu\n",
+                     sizeof(intrusive::list<doubly_node>), sizeof(intrusive::forward_list<singly_node>),
+                     sizeof(intrusive::forward_list<singly_node, intrusive::default_tag, true>));
+
+        bench_stack_and_queue<doubly_node, intrusive::list<doubly_node>>("intrusive::list", n);
+        bench_stack_and_queue<singly_node, intrusive::forward_list<singly_node, intrusive::default_tag, true>>(
+                "intrusive::forward_list", n);
+    }
+
+    struct pooled_object {
+        explicit pooled_object(std::uint64_t id) : id(id) {
+            std::memset(payload, 0, sizeof(payload));
+        }
+
+        std::uint64_t id;
+        char payload[56];
+    };
+
+    struct new_delete_allocator {
+        pooled_object *create(std::uint64_t id) {
+            return new pooled_object(id);
+        }
+
+        void destroy(pooled_object *object) {
+            delete object;
+        }
+    };
+
+    // Allocates n objects and frees them in the given order.
+    template<typename Allocator>
+    void alloc_free_round(Allocator &allocator, std::vector<pooled_object *> &objects,
+                          std::vector<std::size_t> const &order) {
+        for (std::size_t i = 0; i < objects.size(); ++i) {
+            objects[i] = allocator.create(i);
+        }
+        for (std::size_t i : order) {
+            allocator.destroy(objects[i]);
+        }
+    }
+
+    void report_heap(char const *name) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();
+        std::size_t heap = info.arena + info.hblkhd;
+        std::size_t used = info.uordblks + info.hblkhd;
+        std::fprintf(bench::log(), "%-64s heap %10zu bytes, used %10zu bytes, fragmentation %5.1f%%\n",
+                     name, heap, used, heap == 0 ? 0.0 : 100.0 * (heap - used) / heap);
+#else
+        std::fprintf(bench::log(), "%-64s heap statistics are not available on this platform\n", name);
+#endif
+    }
+
+    // Long run of random frees and allocations with a mix of other heap traffic.
+    template<typename Allocator>
+    void churn(Allocator &allocator, std::size_t live, std::size_t steps) {
+        std::mt19937_64 rng(1);
+        std::vector<pooled_object *> objects(live);
+        std::vector<std::vector<char>> noise(live / 4);
+        for (std::size_t i = 0; i < live; ++i) {
+            objects[i] = allocator.create(i);
+        }
+        for (std::size_t step = 0; step < steps; ++step) {
+            std::size_t i = rng() % live;
+            allocator.destroy(objects[i]);
+            noise[rng() % noise.size()].assign(16 + rng() % 512, 'x');
+            objects[i] = allocator.create(step);
+        }
+        for (pooled_object *object : objects) {
+            allocator.destroy(object);
+        }
+    }
+
+    void bench_pool(std::size_t n) {
+        std::vector<pooled_object *> objects(n);
+        std::vector<std::size_t> order = bench::link_order(n, true);
+
+        new_delete_allocator heap;
+        bench::report("pool/new + delete", n, bench::measure_ns(
+                repeats, [] {}, [&] { alloc_free_round(heap, objects, order); }));
+
+        intrusive::object_pool<pooled_object> pool(4096, 256);
+        bench::report("pool/object_pool::create + destroy", n, bench::measure_ns(
+                repeats, [] {}, [&] { alloc_free_round(pool, objects, order); }));
+        {
+            intrusive::object_pool<pooled_object>::local_cache cache(pool);
+            bench::report("pool/local_cache::create + destroy", n, bench::measure_ns(
+                    repeats, [] {}, [&] { alloc_free_round(cache, objects, order); }));
+        }
+        auto stats = pool.stats();
+        std::fprintf(bench::log(), "pool/stats capacity %zu, in use %zu, high water %zu\n",
+                     stats.capacity, stats.in_use, stats.high_water);
+
+        std::size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        std::size_t per_thread = n / threads;
+        auto run_threads = [threads](auto body) {
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t) {
+                workers.emplace_back(body);
+            }
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+        };
+        std::vector<std::size_t> thread_order = bench::link_order(per_thread, true);
+        std::string suffix = "/threads:" + std::to_string(threads);
+        bench::report("pool/new + delete" + suffix, per_thread * threads, bench::measure_ns(
+                repeats, [] {}, [&] {
+                    run_threads([&] {
+                        new_delete_allocator allocator;
+                        std::vector<pooled_object *> local(per_thread);
+                        alloc_free_round(allocator, local, thread_order);
+                    });
+                }));
+        intrusive::object_pool<pooled_object> shared_pool(4096, 256);
+        bench::report("pool/local_cache::create + destroy" + suffix, per_thread * threads,
+                      bench::measure_ns(
+                              repeats, [] {}, [&] {
+                                  run_threads([&] {
+                                      intrusive::object_pool<pooled_object>::local_cache cache(shared_pool);
+                                      std::vector<pooled_object *> local(per_thread);
+                                      alloc_free_round(cache, local, thread_order);
+                                  });
+                              }));
+
+        std::size_t live = std::max<std::size_t>(n / 10, 16);
+        std::size_t steps = n * 5;
+        report_heap("pool/fragmentation/before churn");
+        bench::report("pool/churn/new + delete", steps, bench::measure_ns(
+                1, [] {}, [&] { churn(heap, live, steps); }));
+        report_heap("pool/fragmentation/after new + delete churn");
+        intrusive::object_pool<pooled_object> churn_pool(4096, 256);
+        {
+            intrusive::object_pool<pooled_object>::local_cache cache(churn_pool);
+            bench::report("pool/churn/local_cache", steps, bench::measure_ns(
+                    1, [] {}, [&] { churn(cache, live, steps); }));
+        }
+        report_heap("pool/fragmentation/after object_pool churn");
+        stats = churn_pool.stats();
+        std::fprintf(bench::log(), "pool/churn stats capacity %zu slots, high water %zu, slot utilization at peak %5.1f%%\n",
+                     stats.capacity, stats.high_water, 100.0 * stats.high_water / stats.capacity);
+    }
+
+    struct registry_entry : intrusive::concurrent_list_element<>, intrusive::list_element<> {
+        ~registry_entry() {
+            intrusive::concurrent_list_element<>::unlink();
+        }
+
+        std::size_t value = 1;
+    };
+
+    struct locked_registry {
+        void insert(registry_entry &entry) {
+            std::lock_guard<std::mutex> lock(mutex);
+            list.push_back(entry);
+        }
+
+        void remove(registry_entry &entry) {
+            std::lock_guard<std::mutex> lock(mutex);
+            entry.intrusive::list_element<>::unlink();
+        }
+
+        template<typename F>
+        void for_each(F f) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (registry_entry &entry : list) {
+                f(entry);
+            }
+        }
+
+        std::mutex mutex;
+        intrusive::list<registry_entry> list;
+    };
+
+    struct concurrent_registry {
+        void insert(registry_entry &entry) {
+            list.push_back(entry);
+        }
+
+        void remove(registry_entry &entry) {
+            entry.intrusive::concurrent_list_element<>::unlink();
+        }
+
+        template<typename F>
+        void for_each(F f) {
+            list.for_each(f);
+        }
+
+        intrusive::concurrent_list<registry_entry> list;
+    };
+
+    // Every thread inserts and removes its own entries and sometimes walks the whole registry.
+    template<typename Registry>
+    void registry_workload(Registry &registry, std::size_t threads, std::size_t ops_per_thread) {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&registry, ops_per_thread, t] {
+                std::mt19937 rng(static_cast<unsigned>(t));
+                std::vector<registry_entry> entries(32);
+                std::vector<bool> linked(entries.size());
+                std::size_t sum = 0;
+                for (std::size_t op = 0; op < ops_per_thread; ++op) {
+                    std::size_t i = rng() % entries.size();
+                    if (rng() % 16 == 0) {
+                        registry.for_each([&sum](registry_entry &entry) { sum += entry.value; });
+                    } else if (linked[i]) {
+                        registry.remove(entries[i]);
+                        linked[i] = false;
+                    } else {
+                        registry.insert(entries[i]);
+                        linked[i] = true;
+                    }
+                }
+                for (std::size_t i = 0; i < entries.size(); ++i) {
+                    if (linked[i]) {
+                        registry.remove(entries[i]);
+                    }
+                }
+                bench::do_not_optimize(sum);
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void bench_concurrent(std::size_t n) {
+        std::size_t max_threads = std::max(4u, std::thread::hardware_concurrency());
+        std::size_t ops = std::max<std::size_t>(n / 10, 1000);
+        for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+            std::string suffix = "/threads:" + std::to_string(threads);
+            locked_registry locked;
+            bench::report("concurrent/std::mutex + intrusive::list" + suffix, ops * threads,
+                          bench::measure_ns(repeats, [] {}, [&] { registry_workload(locked, threads, ops); }));
+            concurrent_registry concurrent;
+            bench::report("concurrent/intrusive::concurrent_list" + suffix, ops * threads,
+                          bench::measure_ns(repeats, [] {}, [&] { registry_workload(concurrent, threads, ops); }));
+        }
+    }
+}
+
+namespace {
+    struct expiring_session : intrusive::skip_list_element<> {
+        std::uint64_t expiry = 0;
+        std::uint64_t id = 0;
+    };
+
+    struct expiry_less {
+        bool operator()(expiring_session const &a, expiring_session const &b) const {
+            return a.expiry < b.expiry;
+        }
+
+        bool operator()(expiring_session const &a, std::uint64_t b) const {
+            return a.expiry < b;
+        }
+
+        bool operator()(expiring_session const *a, expiring_session const *b) const {
+            return a->expiry < b->expiry;
+        }
+    };
+
+    struct locked_index {
+        void insert(expiring_session &session) {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            set.insert(&session);
+        }
+
+        void erase(expiring_session &session) {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            auto range = set.equal_range(&session);
+            set.erase(std::find(range.first, range.second, &session));
+        }
+
+        std::uint64_t lower_bound(std::uint64_t expiry) {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            expiring_session probe;
+            probe.expiry = expiry;
+            auto it = set.lower_bound(&probe);
+            return it == set.end() ? 0 : (*it)->id;
+        }
+
+        std::shared_mutex mutex;
+        std::multiset<expiring_session *, expiry_less> set;
+    };
+
+    struct skip_list_index {
+        void insert(expiring_session &session) {
+            list.insert(session);
+        }
+
+        void erase(expiring_session &session) {
+            list.erase(session);
+        }
+
+        std::uint64_t lower_bound(std::uint64_t expiry) {
+            expiring_session *session = list.lower_bound(expiry);
+            return session == nullptr ? 0 : session->id;
+        }
+
+        intrusive::skip_list<expiring_session, intrusive::default_tag, expiry_less> list;
+    };
+
+    // Writers keep replacing their oldest session with a fresh one, readers look up random expiry times.
+    // Erased sessions are never reused during a run, as the skip list requires.
+    template<typename Index>
+    void session_workload(std::size_t readers, std::size_t writers, std::size_t live, std::size_t ops) {
+        std::size_t per_writer = live + ops;
+        std::unique_ptr<expiring_session[]> sessions(new expiring_session[writers * per_writer]);
+        for (std::size_t i = 0; i < writers * per_writer; ++i) {
+            sessions[i].expiry = i;
+            sessions[i].id = i + 1;
+        }
+        Index index;
+        for (std::size_t w = 0; w < writers; ++w) {
+            for (std::size_t i = 0; i < live; ++i) {
+                index.insert(sessions[w * per_writer + i]);
+            }
+        }
+        std::size_t range = writers * per_writer;
+
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                expiring_session *mine = &sessions[w * per_writer];
+                for (std::size_t i = 0; i < ops; ++i) {
+                    index.erase(mine[i]);
+                    index.insert(mine[live + i]);
+                }
+            });
+        }
+        for (std::size_t r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r] {
+                std::mt19937_64 rng(r);
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i < ops; ++i) {
+                    sum += index.lower_bound(rng() % range);
+                }
+                bench::do_not_optimize(sum);
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        auto finish = std::chrono::steady_clock::now();
+        std::string suffix = "/readers:" + std::to_string(readers) + "/writers:" + std::to_string(writers);
+        bench::report(std::string("skip_list/") + (std::is_same_v<Index, locked_index>
+                                                   ? "std::shared_mutex + std::multiset" : "intrusive::skip_list") + suffix,
+                      (readers + writers) * ops, std::chrono::duration<double, std::nano>(finish - start).count());
+    }
+
+    void bench_skip_list(std::size_t n) {
+        std::size_t live = std::max<std::size_t>(n / 10, 1000);
+        std::size_t ops = std::max<std::size_t>(n / 10, 1000);
+        std::size_t max_threads = std::max(4u, std::thread::hardware_concurrency());
+        for (std::size_t writers = 1; writers <= max_threads; writers *= 2) {
+            for (std::size_t readers = 1; readers <= max_threads; readers *= 4) {
+                session_workload<locked_index>(readers, writers, live, ops);
+                session_workload<skip_list_index>(readers, writers, live, ops);
+            }
+        }
+    }
+}
+
+namespace {
+    // Element with a payload of Bytes bytes; the first word is the value that is read.
+    template<std::size_t Bytes>
+    struct payload {
+        static_assert(Bytes % sizeof(std::size_t) == 0 && Bytes != 0);
+
+        explicit payload(std::size_t value) noexcept: words{value} {}
+
+        std::size_t words[Bytes / sizeof(std::size_t)];
+    };
+
+    template<std::size_t Bytes>
+    struct ops_node : intrusive::list_element<> {
+        explicit ops_node(std::size_t value) noexcept: data(value) {}
+
+        payload<Bytes> data;
+    };
+
+    // The adapters below give the three containers one interface for the operation matrix.
+    // The container starts with fill(count) elements linked in the given order;
+    // std::vector is always contiguous.
+
+    template<std::size_t Bytes>
+    struct intrusive_adapter {
+        static constexpr char const *name = "intrusive::list";
+        static constexpr bool linear_insert = true;
+
+        intrusive_adapter(std::size_t capacity, bool shuffled) : order(bench::link_order(capacity, shuffled)) {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                storage.push_back(std::make_unique<ops_node<Bytes>>(i));
+            }
+        }
+
+        void fill(std::size_t count) {
+            list.clear();
+            next = 0;
+            push_back(count);
+        }
+
+        void push_back(std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                list.push_back(*storage[order[next++]]);
+            }
+        }
+
+        void pop_back_all() {
+            while (!list.empty()) {
+                list.pop_back();
+            }
+        }
+
+        void insert_before_each() {
+            for (auto it = list.begin(); it != list.end(); ++it) {
+                list.insert(it, *storage[order[next++]]);
+            }
+        }
+
+        void erase_every_other() {
+            for (auto it = list.begin(); it != list.end() && ++it != list.end();) {
+                it = list.erase(it);
+            }
+        }
+
+        void find_middle() {
+            middle = std::next(list.begin(), std::distance(list.begin(), list.end()) / 2);
+        }
+
+        // Moves the back half to another list and back, rounds times.
+        void splice_halves(std::size_t rounds) {
+            intrusive::list<ops_node<Bytes>> other;
+            for (std::size_t i = 0; i < rounds; ++i) {
+                other.splice(other.end(), list, middle, list.end());
+                list.splice(list.end(), other, other.begin(), other.end());
+            }
+        }
+
+        std::size_t sum() const {
+            std::size_t result = 0;
+            for (ops_node<Bytes> const &node : list) {
+                result += node.data.words[0];
+            }
+            return result;
+        }
+
+        std::vector<std::size_t> order;
+        std::vector<std::unique_ptr<ops_node<Bytes>>> storage;
+        std::size_t next = 0;
+        intrusive::list<ops_node<Bytes>> list;
+        typename intrusive::list<ops_node<Bytes>>::iterator middle;
+    };
+
+    template<std::size_t Bytes>
+    struct std_list_adapter {
+        static constexpr char const *name = "std::list";
+        static constexpr bool linear_insert = true;
+
+        std_list_adapter(std::size_t capacity, bool shuffled) : shuffled(shuffled), capacity(capacity) {}
+
+        // Nodes are allocated in memory order and then relinked by a random key.
+        void fill(std::size_t count) {
+            list.clear();
+            std::vector<std::size_t> keys = bench::link_order(count, shuffled);
+            for (std::size_t key : keys) {
+                list.emplace_back(key);
+            }
+            if (shuffled) {
+                list.sort([](payload<Bytes> const &a, payload<Bytes> const &b) { return a.words[0] < b.words[0]; });
+            }
+        }
+
+        void push_back(std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                list.emplace_back(i);
+            }
+        }
+
+        void pop_back_all() {
+            while (!list.empty()) {
+                list.pop_back();
+            }
+        }
+
+        void insert_before_each() {
+            for (auto it = list.begin(); it != list.end(); ++it) {
+                list.emplace(it, capacity);
+            }
+        }
+
+        void erase_every_other() {
+            for (auto it = list.begin(); it != list.end() && ++it != list.end();) {
+                it = list.erase(it);
+            }
+        }
+
+        // Splicing a range from another list is linear: std::list has to count it.
+        void find_middle() {
+            middle = std::next(list.begin(), list.size() / 2);
+        }
+
+        void splice_halves(std::size_t rounds) {
+            std::list<payload<Bytes>> other;
+            for (std::size_t i = 0; i < rounds; ++i) {
+                other.splice(other.end(), list, middle, list.end());
+                list.splice(list.end(), other, other.begin(), other.end());
+            }
+        }
+
+        std::size_t sum() const {
+            std::size_t result = 0;
+            for (payload<Bytes> const &value : list) {
+                result += value.words[0];
+            }
+            return result;
+        }
+
+        bool shuffled;
+        std::size_t capacity;
+        std::list<payload<Bytes>> list;
+        typename std::list<payload<Bytes>>::iterator middle;
+    };
+
+    template<std::size_t Bytes>
+    struct std_vector_adapter {
+        static constexpr char const *name = "std::vector";
+        static constexpr bool linear_insert = false;
+
+        std_vector_adapter(std::size_t capacity, bool) : capacity(capacity) {}
+
+        void fill(std::size_t count) {
+            vector = {};
+            push_back(count);
+        }
+
+        void push_back(std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                vector.emplace_back(i);
+            }
+        }
+
+        void pop_back_all() {
+            while (!vector.empty()) {
+                vector.pop_back();
+            }
+        }
+
+        // Quadratic, as is erase_every_other(): every call shifts the tail.
+        void insert_before_each() {
+            for (auto it = vector.begin(); it != vector.end(); it += 2) {
+                it = vector.emplace(it, capacity);
+            }
+        }
+
+        void erase_every_other() {
+            for (auto it = vector.begin(); it != vector.end() && ++it != vector.end();) {
+                it = vector.erase(it);
+            }
+        }
+
+        void find_middle() {
+            middle = vector.size() / 2;
+        }
+
+        void splice_halves(std::size_t rounds) {
+            std::vector<payload<Bytes>> other;
+            for (std::size_t i = 0; i < rounds; ++i) {
+                other.insert(other.end(), std::make_move_iterator(vector.begin() + middle),
+                             std::make_move_iterator(vector.end()));
+                vector.erase(vector.begin() + middle, vector.end());
+                vector.insert(vector.end(), std::make_move_iterator(other.begin()),
+                              std::make_move_iterator(other.end()));
+                other.clear();
+            }
+        }
+
+        std::size_t sum() const {
+            std::size_t result = 0;
+            for (payload<Bytes> const &value : vector) {
+                result += value.words[0];
+            }
+            return result;
+        }
+
+        std::size_t capacity;
+        std::vector<payload<Bytes>> vector;
+        std::size_t middle = 0;
+    };
+
+    // std::vector is skipped in the quadratic operations once they would move more bytes than this
+    double const quadratic_limit = 1e11;
+
+    template<template<std::size_t> class Adapter, std::size_t Bytes>
+    void bench_operations(std::size_t length, bool shuffled) {
+        Adapter<Bytes> container(length, shuffled);
+        std::string suffix = "/" + std::string(Adapter<Bytes>::name) + "/bytes:" + std::to_string(Bytes) +
+                             "/order:" + (shuffled ? "shuffled" : "sequential") + "/length:" + std::to_string(length);
+        // keep the amount of work per measurement roughly the same for all lengths
+        std::size_t runs = std::clamp<std::size_t>(1000000 / length, repeats, 100);
+        std::size_t half = length / 2;
+
+        bench::report("ops/push_back" + suffix, length, bench::measure_ns(
+                runs, [&] { container.fill(0); },
+                [&] { container.push_back(length); }));
+        bench::report("ops/pop_back" + suffix, length, bench::measure_ns(
+                runs, [&] { container.fill(length); },
+                [&] { container.pop_back_all(); }));
+        bench::report("ops/iterate" + suffix, length, bench::measure_ns(
+                runs, [&] { container.fill(length); },
+                [&] { bench::do_not_optimize(container.sum()); }));
+        if (Adapter<Bytes>::linear_insert || double(length) * length * Bytes <= quadratic_limit) {
+            bench::report("ops/insert before each" + suffix, half, bench::measure_ns(
+                    runs, [&] { container.fill(half); },
+                    [&] { container.insert_before_each(); }));
+            bench::report("ops/erase every other" + suffix, half, bench::measure_ns(
+                    runs, [&] { container.fill(length); },
+                    [&] { container.erase_every_other(); }));
+        }
+        std::size_t rounds = std::max<std::size_t>(1000000 / length, 1);
+        container.fill(length);
+        container.find_middle();
+        bench::report("ops/splice half" + suffix, 2 * rounds, bench::measure_ns(
+                runs, [] {},
+                [&] { container.splice_halves(rounds); }));
+    }
+
+    template<std::size_t Bytes>
+    void bench_operations(std::vector<std::size_t> const &lengths) {
+        for (std::size_t length : lengths) {
+            for (bool shuffled : {false, true}) {
+                bench_operations<intrusive_adapter, Bytes>(length, shuffled);
+                bench_operations<std_list_adapter, Bytes>(length, shuffled);
+            }
+            bench_operations<std_vector_adapter, Bytes>(length, false);
+        }
+    }
+
+    void bench_operations(std::vector<std::size_t> const &lengths) {
+        bench_operations<8>(lengths);
+        bench_operations<64>(lengths);
+        bench_operations<256>(lengths);
+    }
+
+    std::vector<std::size_t> parse_sizes(char const *list) {
+        std::vector<std::size_t> result;
+        for (char *end; *list != '\0'; list = *end == ',' ? end + 1 : end) {
+            result.push_back(std::strtoull(list, &end, 10));
+            if (end == list)
+                break;
+        }
+        return result;
+    }
+
+    bool starts_with(char const *s, char const *prefix) {
+        return std::strncmp(s, prefix, std::strlen(prefix)) == 0;
+    }
+
+    void usage(char const *program) {
+        std::fprintf(stderr, "usage: %s [--size=N] [--lengths=N,N,...] [--benchmarks=NAME,...] [--json[=FILE]]\n"
+                             "benchmarks: ops, clear, traverse, sort, compact, forward, pool, concurrent, skip_list (default: all)\n"
+                             "--size sets the element count of all benchmarks but ops, --lengths the list lengths of ops\n",
+                     program);
+    }
+}
+
+
+int main(int argc, char **argv) {
+    std::size_t n = 1000000;
+    std::vector<std::size_t> lengths = {1000, 100000, 1000000};
+    std::string selected;
+    char const *json_file = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        char const *arg = argv[i];
+        if (starts_with(arg, "--size=")) {
+            n = std::strtoull(arg + 7, nullptr, 10);
+        } else if (starts_with(arg, "--lengths=")) {
+            lengths = parse_sizes(arg + 10);
+        } else if (starts_with(arg, "--benchmarks=")) {
+            selected = "," + std::string(arg + 13) + ",";
+        } else if (std::strcmp(arg, "--json") == 0) {
+            bench::current_reporter().json = true;
+        } else if (starts_with(arg, "--json=")) {
+            json_file = arg + 7;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    auto run = [&selected](char const *name) {
+        return selected.empty() || selected.find("," + std::string(name) + ",") != std::string::npos;
+    };
+    if (run("ops")) bench_operations(lengths);
+    if (run("clear")) bench_clear(n);
+    if (run("traverse")) bench_traversal(n);
+    if (run("sort")) bench_sort(n);
+    if (run("compact")) bench_compact(n);
+    if (run("forward")) bench_forward(n);
+    if (run("pool")) bench_pool(n);
+    if (run("concurrent")) bench_concurrent(n);
+    if (run("skip_list")) bench_skip_list(n);
+
+    bench::reporter const &reporter = bench::current_reporter();
+    if (reporter.json) {
+        reporter.write_json(stdout);
+    }
+    if (json_file != nullptr) {
+        std::FILE *out = std::fopen(json_file, "w");
+        if (out == nullptr) {
+            std::perror(json_file);
+            return 1;
+        }
+        reporter.write_json(out);
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -1,11 +1,49 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <iterator>
 
 namespace intrusive {
 
     struct default_tag;
 
+    namespace details {
+        template<bool ConstantTimeSize>
+        struct size_counter {
+            void increase(std::size_t) noexcept {}
+
+            void decrease(std::size_t) noexcept {}
+
+            void reset_size() noexcept {}
+        };
+
+        template<>
+        struct size_counter<true> {
+            void increase(std::size_t n) noexcept {
+                count += n;
+            }
+
+            void decrease(std::size_t n) noexcept {
+                count -= n;
+            }
+
+            void reset_size() noexcept {
+                count = 0;
+            }
+
+            std::size_t count = 0;
+        };
+
+        inline void prefetch(void const *ptr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(ptr);
+#else
+            (void) ptr;
+#endif
+        }
+    }
+
     template<typename Tag = default_tag>
     struct list_element {
 
@@ -109,10 +147,15 @@ namespace intrusive {
         base *current;
     };
 
-    template<typename T, typename Tag = default_tag>
-    struct list {
+    // With ConstantTimeSize the list keeps an element counter, so size() is O(1)
+    // and splice() of a range from another list is O(1) only when the length is given.
+    // Elements of such a list must leave it through the list itself: unlink() or
+    // destruction of a linked element bypasses the counter.
+    template<typename T, typename Tag = default_tag, bool ConstantTimeSize = false>
+    struct list : private details::size_counter<ConstantTimeSize> {
         typedef list_iterator<T, Tag> iterator;
         typedef list_iterator<const T, Tag> const_iterator;
+        static constexpr bool constant_time_size = ConstantTimeSize;
 
         static_assert(std::is_convertible_v<T &, list_element<Tag> &>,
                       "value type is not convertible to list_element");
@@ -149,9 +192,55 @@ namespace intrusive {
             return *this;
         };
 
+        void swap(list &other) noexcept {
+            list temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+
         void clear() noexcept {
-            while (!this->empty()) {
-                erase(begin());
+            list_element<Tag> *current = head.next;
+            while (current != &head) {
+                list_element<Tag> *next = current->next;
+                current->next = current->prev = nullptr;
+                current = next;
+            }
+            make_empty_head();
+        }
+
+        // Detaches all elements in O(1) without touching them one by one.
+        // Detached elements stay linked to each other in a ring without a head,
+        // so they may be destroyed in any order, but each of them must be
+        // unlink()ed before it is inserted into a list again.
+        void detach_all() noexcept {
+            if (empty())
+                return;
+            head.next->prev = head.prev;
+            head.prev->next = head.next;
+            make_empty_head();
+        }
+
+        // Unlinks every element and passes it to disposer (e.g. to delete owned nodes)
+        // in a single pass, prefetching the next element while the current one is disposed.
+        // disposer must not throw.
+        template<typename Disposer>
+        void dispose_all(Disposer disposer) noexcept {
+            list_element<Tag> *current = head.next;
+            make_empty_head();
+            while (current != &head) {
+                list_element<Tag> *next = current->next;
+                details::prefetch(next);
+                current->next = current->prev = nullptr;
+                disposer(static_cast<T &>(*current));
+                current = next;
+            }
+        }
+
+        std::size_t size() const noexcept {
+            if constexpr (ConstantTimeSize) {
+                return this->count;
+            } else {
+                return std::distance(begin(), end());
             }
         }
 
@@ -161,6 +250,7 @@ namespace intrusive {
 
         void pop_back() noexcept {
             head.prev->unlink();
+            this->decrease(1);
         }
 
         T &back() noexcept {
@@ -222,6 +312,7 @@ namespace intrusive {
             element.prev = next_element.prev;
             element.prev->next = next_element.prev = &element;
             element.next = &next_element;
+            this->increase(1);
             return iterator(element);
         }
 
@@ -230,14 +321,32 @@ namespace intrusive {
             auto &list = const_cast<list_element<Tag> &>(ll);
             list_element<Tag> &list1 = *list.next;
             list.unlink();
+            this->decrease(1);
             return list1;
         }
 
         void splice(const_iterator pos, list &other, const_iterator first, const_iterator last) noexcept {
+            if constexpr (ConstantTimeSize) {
+                if (&other != this) {
+                    splice(pos, other, first, last, std::distance(first, last));
+                    return;
+                }
+            }
+            splice(pos, other, first, last, 0);
+        }
+
+        // n must be equal to std::distance(first, last)
+        void splice(const_iterator pos, list &other, const_iterator first, const_iterator last,
+                    std::size_t n) noexcept {
 
             if (first == last)
                 return;
 
+            if (&other != this) {
+                other.decrease(n);
+                this->increase(n);
+            }
+
             auto triple_swap = [](list_element<Tag> *&a, list_element<Tag> *&b, list_element<Tag> *&c) {
                 list_element<Tag> *t = a;
                 a = b;
@@ -253,19 +362,119 @@ namespace intrusive {
             triple_swap(pos_ptr->prev, last_ptr->prev, first_ptr->prev);
         }
 
+        // Moves all elements of sorted other into this sorted list, relinking them only.
+        // Stable: of equal elements those from *this go first.
+        template<typename Compare>
+        void merge(list &other, Compare cmp) {
+            if (&other == this)
+                return;
+            iterator first1 = begin();
+            iterator first2 = other.begin();
+            while (first1 != end() && first2 != other.end()) {
+                if (cmp(*first2, *first1)) {
+                    iterator run_end = std::next(first2);
+                    std::size_t run_length = 1;
+                    while (run_end != other.end() && cmp(*run_end, *first1)) {
+                        ++run_end;
+                        ++run_length;
+                    }
+                    splice(first1, other, first2, run_end, run_length);
+                    first2 = run_end;
+                } else {
+                    ++first1;
+                }
+            }
+            splice(end(), other, first2, other.end(), other.known_size());
+        }
+
+        void merge(list &other) {
+            merge(other, std::less<>());
+        }
+
+        // Stable bottom-up merge sort done by relinking, O(n log n) comparisons, no allocations.
+        // If cmp throws, all elements stay in the list in unspecified order.
+        template<typename Compare>
+        void sort(Compare cmp) {
+            if (head.next == &head || head.next->next == &head)
+                return;
+
+            list carry;
+            list bins[64];
+            list *fill = bins;
+            try {
+                do {
+                    carry.splice(carry.begin(), *this, begin(), std::next(begin()), 1);
+                    list *bin = bins;
+                    for (; bin != fill && !bin->empty(); ++bin) {
+                        bin->merge(carry, cmp);
+                        carry.swap(*bin);
+                    }
+                    carry.swap(*bin);
+                    if (bin == fill)
+                        ++fill;
+                } while (!empty());
+
+                for (list *bin = bins + 1; bin != fill; ++bin) {
+                    bin->merge(*(bin - 1), cmp);
+                }
+            } catch (...) {
+                splice(end(), carry, carry.begin(), carry.end(), carry.known_size());
+                for (list *bin = bins; bin != fill; ++bin) {
+                    splice(end(), *bin, bin->begin(), bin->end(), bin->known_size());
+                }
+                throw;
+            }
+            swap(*(fill - 1));
+        }
+
+        void sort() {
+            sort(std::less<>());
+        }
+
     private :
 
+        std::size_t known_size() const noexcept {
+            if constexpr (ConstantTimeSize) {
+                return this->count;
+            } else {
+                return 0;
+            }
+        }
+
         void take_head_from(list &other) {
             head.next = other.head.next;
             head.prev = other.head.prev;
             head.next->prev = head.prev->next = &head;
+            if constexpr (ConstantTimeSize) {
+                this->count = other.count;
+            }
             other.make_empty_head();
         }
 
         void make_empty_head() {
             head.next = head.prev = &head;
+            this->reset_size();
         }
 
         list_element<Tag> head;
     };
+
+    // Calls f for every element of list in order, prefetching the element
+    // that is distance steps ahead of the current one.
+    template<typename List, typename F>
+    void for_each_prefetched(List &list, F f, std::size_t distance = 4) {
+        auto current = list.begin();
+        auto ahead = current;
+        auto const end = list.end();
+        for (std::size_t i = 0; i < distance && ahead != end; ++i, ++ahead) {
+            details::prefetch(&*ahead);
+        }
+        for (; current != end; ++current) {
+            if (ahead != end) {
+                details::prefetch(&*ahead);
+                ++ahead;
+            }
+            f(*current);
+        }
+    }
 }
\ No newline at end of file
@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
 #include "intrusive_list.h"
+#include "parallel_sort.h"
 #include "test_utils.h"
+#include <algorithm>
 #include <list>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 struct node : intrusive::list_element<> {
     explicit node(int value)
@@ -802,3 +808,324 @@ TEST(intrusive_list_testing, multiple_tags) {
     expect_eq(list_b, {3, 2, 1});
 }
 
+
+using counted_list = intrusive::list<node, intrusive::default_tag, true>;
+
+TEST(intrusive_list_testing, size_default) {
+    intrusive::list<node> list;
+    node a(1), b(2), c(3);
+    EXPECT_EQ(0, list.size());
+    mass_push_back(list, a, b, c);
+    EXPECT_EQ(3, list.size());
+    list.pop_front();
+    EXPECT_EQ(2, list.size());
+}
+
+TEST(intrusive_list_testing, size_counted_push_pop) {
+    counted_list list;
+    node a(1), b(2), c(3), d(4);
+    EXPECT_EQ(0, list.size());
+    mass_push_back(list, a, b, c);
+    list.push_front(d);
+    EXPECT_EQ(4, list.size());
+    list.pop_back();
+    EXPECT_EQ(3, list.size());
+    list.pop_front();
+    EXPECT_EQ(2, list.size());
+    expect_eq(list, {1, 2});
+}
+
+TEST(intrusive_list_testing, size_counted_insert_erase) {
+    counted_list list;
+    node a(1), b(2), c(3);
+    mass_push_back(list, a, c);
+    list.insert(std::next(list.begin()), b);
+    EXPECT_EQ(3, list.size());
+    list.erase(list.begin());
+    EXPECT_EQ(2, list.size());
+    list.clear();
+    EXPECT_EQ(0, list.size());
+    EXPECT_TRUE(list.empty());
+}
+
+TEST(intrusive_list_testing, size_counted_move) {
+    counted_list list1, list2;
+    node a(1), b(2), c(3), d(4);
+    mass_push_back(list1, a, b, c);
+    mass_push_back(list2, d);
+    counted_list list3 = std::move(list1);
+    EXPECT_EQ(0, list1.size());
+    EXPECT_EQ(3, list3.size());
+    list2 = std::move(list3);
+    EXPECT_EQ(0, list3.size());
+    EXPECT_EQ(3, list2.size());
+    expect_eq(list2, {1, 2, 3});
+}
+
+TEST(intrusive_list_testing, size_counted_splice) {
+    counted_list c1, c2;
+    node a(1), b(2), c(3), d(4);
+    node e(5), f(6), g(7), h(8);
+    mass_push_back(c1, a, b, c, d);
+    mass_push_back(c2, e, f, g, h);
+    c1.splice(c1.begin(), c2, std::next(c2.begin()), std::prev(c2.end()));
+    expect_eq(c1, {6, 7, 1, 2, 3, 4});
+    expect_eq(c2, {5, 8});
+    EXPECT_EQ(6, c1.size());
+    EXPECT_EQ(2, c2.size());
+    c1.splice(c1.end(), c2, c2.begin(), c2.end(), 2);
+    expect_eq(c1, {6, 7, 1, 2, 3, 4, 5, 8});
+    EXPECT_EQ(8, c1.size());
+    EXPECT_EQ(0, c2.size());
+}
+
+TEST(intrusive_list_testing, size_counted_splice_self) {
+    counted_list c1;
+    node a(1), b(2), c(3), d(4), e(5);
+    mass_push_back(c1, a, b, c, d, e);
+    c1.splice(std::next(c1.begin()), c1, std::next(c1.begin(), 2), std::prev(c1.end()));
+    expect_eq(c1, {1, 3, 4, 2, 5});
+    EXPECT_EQ(5, c1.size());
+}
+
+TEST(intrusive_list_testing, size_counted_no_overhead_by_default) {
+    EXPECT_EQ(sizeof(intrusive::list_element<>), sizeof(intrusive::list<node>));
+    EXPECT_EQ(sizeof(intrusive::list_element<>) + sizeof(std::size_t), sizeof(counted_list));
+}
+
+TEST(intrusive_list_testing, clear_unlinks_elements) {
+    intrusive::list<node> list1, list2;
+    node a(1), b(2), c(3);
+    mass_push_back(list1, a, b, c);
+    list1.clear();
+    EXPECT_TRUE(list1.empty());
+    mass_push_back(list2, c, b, a);
+    expect_eq(list2, {3, 2, 1});
+}
+
+TEST(intrusive_list_testing, detach_all) {
+    counted_list list;
+    node a(1), b(2), c(3);
+    mass_push_back(list, a, b, c);
+    list.detach_all();
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(0, list.size());
+
+    node d(4);
+    list.push_back(d);
+    expect_eq(list, {4});
+}
+
+TEST(intrusive_list_testing, detach_all_destroy_in_any_order) {
+    intrusive::list<node> list;
+    auto a = std::make_unique<node>(1);
+    auto b = std::make_unique<node>(2);
+    auto c = std::make_unique<node>(3);
+    mass_push_back(list, *a, *b, *c);
+    list.detach_all();
+    b.reset();
+    a.reset();
+    c.reset();
+    EXPECT_TRUE(list.empty());
+}
+
+TEST(intrusive_list_testing, detach_all_reinsert_after_unlink) {
+    intrusive::list<node> list1, list2;
+    node a(1), b(2), c(3);
+    mass_push_back(list1, a, b, c);
+    list1.detach_all();
+    a.unlink();
+    b.unlink();
+    c.unlink();
+    mass_push_back(list2, b, c, a);
+    expect_eq(list2, {2, 3, 1});
+}
+
+TEST(intrusive_list_testing, dispose_all) {
+    counted_list list;
+    for (int i = 0; i < 5; ++i) {
+        list.push_back(*new node(i));
+    }
+    int sum = 0;
+    list.dispose_all([&sum](node &n) {
+        sum += n.value;
+        delete &n;
+    });
+    EXPECT_EQ(10, sum);
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(0, list.size());
+}
+
+TEST(intrusive_list_testing, for_each_prefetched) {
+    for (std::size_t distance : {0, 1, 2, 5, 100}) {
+        intrusive::list<node> list;
+        node a(1), b(2), c(3), d(4), e(5);
+        mass_push_back(list, a, b, c, d, e);
+        std::vector<int> visited;
+        intrusive::for_each_prefetched(list, [&visited](node &n) { visited.push_back(n.value); }, distance);
+        EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), visited);
+    }
+}
+
+TEST(intrusive_list_testing, for_each_prefetched_const_empty) {
+    intrusive::list<node> const list;
+    std::size_t calls = 0;
+    intrusive::for_each_prefetched(list, [&calls](node const &) { ++calls; });
+    EXPECT_EQ(0, calls);
+}
+
+TEST(intrusive_list_testing, for_each_prefetched_modify) {
+    intrusive::list<node> list;
+    node a(1), b(2), c(3);
+    mass_push_back(list, a, b, c);
+    intrusive::for_each_prefetched(list, [](node &n) { n.value *= 10; }, 1);
+    expect_eq(list, {10, 20, 30});
+}
+
+struct node_less {
+    bool operator()(node const &a, node const &b) const {
+        return a.value < b.value;
+    }
+};
+
+TEST(intrusive_list_testing, merge) {
+    counted_list c1, c2;
+    node a(1), b(3), c(5), d(7);
+    node e(2), f(3), g(4), h(8), i(9);
+    mass_push_back(c1, a, b, c, d);
+    mass_push_back(c2, e, f, g, h, i);
+    c1.merge(c2, node_less());
+    expect_eq(c1, {1, 2, 3, 3, 4, 5, 7, 8, 9});
+    EXPECT_TRUE(c2.empty());
+    EXPECT_EQ(9, c1.size());
+    EXPECT_EQ(0, c2.size());
+    EXPECT_EQ(&b, &*std::next(c1.begin(), 2));
+    EXPECT_EQ(&f, &*std::next(c1.begin(), 3));
+}
+
+TEST(intrusive_list_testing, merge_into_empty) {
+    intrusive::list<node> c1, c2;
+    node a(1), b(2);
+    mass_push_back(c2, a, b);
+    c1.merge(c2, node_less());
+    expect_eq(c1, {1, 2});
+    EXPECT_TRUE(c2.empty());
+    c1.merge(c2, node_less());
+    expect_eq(c1, {1, 2});
+}
+
+TEST(intrusive_list_testing, sort) {
+    intrusive::list<node> list;
+    node a(5), b(3), c(9), d(1), e(3), f(7);
+    mass_push_back(list, a, b, c, d, e, f);
+    list.sort(node_less());
+    expect_eq(list, {1, 3, 3, 5, 7, 9});
+    EXPECT_EQ(&b, &*std::next(list.begin()));
+    EXPECT_EQ(&e, &*std::next(list.begin(), 2));
+}
+
+TEST(intrusive_list_testing, sort_small) {
+    intrusive::list<node> list;
+    list.sort(node_less());
+    EXPECT_TRUE(list.empty());
+    node a(1);
+    list.push_back(a);
+    list.sort(node_less());
+    expect_eq(list, {1});
+}
+
+TEST(intrusive_list_testing, sort_large_counted) {
+    std::vector<std::unique_ptr<node>> nodes;
+    counted_list list;
+    for (int i = 0; i < 10000; ++i) {
+        nodes.push_back(std::make_unique<node>((i * 7919) % 10007));
+        list.push_back(*nodes.back());
+    }
+    list.sort(node_less());
+    EXPECT_EQ(10000, list.size());
+    EXPECT_TRUE(std::is_sorted(list.begin(), list.end(), node_less()));
+    EXPECT_EQ(10000, std::distance(list.begin(), list.end()));
+}
+
+TEST(intrusive_list_testing, sort_throwing_compare) {
+    intrusive::list<node> list;
+    node a(5), b(3), c(9), d(1), e(3), f(7);
+    mass_push_back(list, a, b, c, d, e, f);
+    int calls = 0;
+    EXPECT_THROW(list.sort([&calls](node const &x, node const &y) {
+        if (++calls == 4)
+            throw std::runtime_error("compare");
+        return x.value < y.value;
+    }), std::runtime_error);
+    EXPECT_EQ(6, list.size());
+    list.sort(node_less());
+    expect_eq(list, {1, 3, 3, 5, 7, 9});
+}
+
+TEST(intrusive_list_testing, parallel_sort) {
+    for (std::size_t threads : {1, 2, 3, 4, 7}) {
+        std::vector<std::unique_ptr<node>> nodes;
+        counted_list list;
+        for (int i = 0; i < 20000; ++i) {
+            nodes.push_back(std::make_unique<node>((i * 7919) % 10007));
+            list.push_back(*nodes.back());
+        }
+        intrusive::parallel_sort(list, node_less(), threads);
+        EXPECT_EQ(20000, list.size());
+        EXPECT_EQ(20000, std::distance(list.begin(), list.end()));
+        EXPECT_TRUE(std::is_sorted(list.begin(), list.end(), node_less()));
+    }
+}
+
+TEST(intrusive_list_testing, parallel_sort_stable) {
+    for (std::size_t threads : {2, 3, 4, 7}) {
+        std::vector<std::unique_ptr<node>> nodes;
+        std::map<node const *, std::size_t> order;
+        counted_list list;
+        for (int i = 0; i < 20000; ++i) {
+            nodes.push_back(std::make_unique<node>((i * 7919) % 100));
+            order[nodes.back().get()] = i;
+            list.push_back(*nodes.back());
+        }
+        intrusive::parallel_sort(list, node_less(), threads);
+        EXPECT_TRUE(std::is_sorted(list.begin(), list.end(), node_less()));
+        for (auto it = list.begin(), next = std::next(it); next != list.end(); ++it, ++next) {
+            if (it->value == next->value) {
+                EXPECT_LT(order[&*it], order[&*next]);
+            }
+        }
+    }
+}
+
+TEST(intrusive_list_testing, parallel_sort_stable_uncounted) {
+    for (std::size_t threads : {2, 3, 4, 7}) {
+        std::vector<std::unique_ptr<node>> nodes;
+        std::map<node const *, std::size_t> order;
+        intrusive::list<node> list;
+        for (int i = 0; i < 20000; ++i) {
+            nodes.push_back(std::make_unique<node>((i * 7919) % 100));
+            order[nodes.back().get()] = i;
+            list.push_back(*nodes.back());
+        }
+        intrusive::parallel_sort(list, node_less(), threads);
+        EXPECT_EQ(20000, list.size());
+        EXPECT_TRUE(std::is_sorted(list.begin(), list.end(), node_less()));
+        for (auto it = list.begin(), next = std::next(it); next != list.end(); ++it, ++next) {
+            if (it->value == next->value) {
+                EXPECT_LT(order[&*it], order[&*next]);
+            }
+        }
+    }
+}
+
+TEST(intrusive_list_testing, parallel_sort_fewer_elements_than_threads) {
+    intrusive::list<node> list;
+    intrusive::parallel_sort(list, node_less(), 8);
+    EXPECT_TRUE(list.empty());
+    node a(5), b(3), c(9), d(1), e(3), f(7);
+    mass_push_back(list, a, b, c, d, e, f);
+    intrusive::parallel_sort(list, node_less(), 8);
+    expect_eq(list, {1, 3, 3, 5, 7, 9});
+    EXPECT_EQ(&b, &*std::next(list.begin()));
+    EXPECT_EQ(&e, &*std::next(list.begin(), 2));
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "intrusive_list.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace intrusive {
+
+    struct pool_tag;
+
+    // Pool of fixed-size slots for objects of type T allocated in slabs.
+    // Free slots hold a list_element hook and are kept in counted intrusive lists,
+    // so batches move between the pool and per-thread caches without walking them.
+    template<typename T>
+    struct object_pool {
+    private:
+        struct slot : list_element<pool_tag> {};
+
+        using free_list = list<slot, pool_tag, true>;
+        using storage_t = std::aligned_storage_t<std::max(sizeof(T), sizeof(slot)),
+                std::max(alignof(T), alignof(slot))>;
+
+    public:
+        struct statistics {
+            std::size_t capacity;
+            std::size_t in_use;
+            std::size_t high_water;
+        };
+
+        explicit object_pool(std::size_t slab_size = 1024, std::size_t batch_size = 64)
+                : slab_size(std::max<std::size_t>(slab_size, 1)), batch_size(std::max<std::size_t>(batch_size, 1)) {}
+
+        object_pool(object_pool const &) = delete;
+
+        object_pool &operator=(object_pool const &) = delete;
+
+        // All objects must be destroyed and all local caches gone before the pool is.
+        ~object_pool() {
+            full_batches.clear();
+            free.clear();
+        }
+
+        template<typename... Args>
+        T *create(Args &&... args) {
+            slot *s;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (free.empty()) {
+                    grow();
+                }
+                s = &free.front();
+                free.pop_front();
+            }
+            T *result;
+            try {
+                result = construct(s, std::forward<Args>(args)...);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                free.push_front(*s);
+                throw;
+            }
+            account(1);
+            return result;
+        }
+
+        void destroy(T *object) noexcept {
+            if (object == nullptr)
+                return;
+            slot *s = release(object);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                free.push_front(*s);
+            }
+            account(-1);
+        }
+
+        // In-use counts of local caches are published once per batch, so they may lag
+        // behind by up to a batch per cache.
+        statistics stats() const noexcept {
+            return {capacity.load(std::memory_order_relaxed),
+                    static_cast<std::size_t>(in_use.load(std::memory_order_relaxed)),
+                    static_cast<std::size_t>(high_water.load(std::memory_order_relaxed))};
+        }
+
+        // Per-thread front end of the pool. Keeps up to two batches of free slots
+        // (the loaded one and a spare) and exchanges full batches with the pool in O(1).
+        // Must be used by one thread at a time.
+        struct local_cache {
+
+            explicit local_cache(object_pool &pool) noexcept: pool(&pool) {}
+
+            local_cache(local_cache const &) = delete;
+
+            local_cache &operator=(local_cache const &) = delete;
+
+            ~local_cache() {
+                pool->give_back(loaded, in_use_delta);
+                pool->give_back(spare, 0);
+            }
+
+            std::size_t cached() const noexcept {
+                return loaded.size() + spare.size();
+            }
+
+            template<typename... Args>
+            T *create(Args &&... args) {
+                if (loaded.empty()) {
+                    if (!spare.empty()) {
+                        loaded.swap(spare);
+                    } else {
+                        pool->take(loaded, in_use_delta);
+                        in_use_delta = 0;
+                    }
+                }
+                slot *s = &loaded.front();
+                loaded.pop_front();
+                T *result;
+                try {
+                    result = construct(s, std::forward<Args>(args)...);
+                } catch (...) {
+                    loaded.push_front(*s);
+                    throw;
+                }
+                ++in_use_delta;
+                return result;
+            }
+
+            void destroy(T *object) noexcept {
+                if (object == nullptr)
+                    return;
+                if (loaded.size() >= pool->batch_size) {
+                    if (!spare.empty()) {
+                        pool->give_back(spare, in_use_delta);
+                        in_use_delta = 0;
+                    }
+                    loaded.swap(spare);
+                }
+                loaded.push_front(*release(object));
+                --in_use_delta;
+            }
+
+        private:
+            object_pool *pool;
+            free_list loaded;
+            free_list spare;
+            std::ptrdiff_t in_use_delta = 0;
+        };
+
+    private:
+        template<typename... Args>
+        static T *construct(slot *s, Args &&... args) {
+            s->~slot();
+            try {
+                return new(static_cast<void *>(s)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                new(static_cast<void *>(s)) slot();
+                throw;
+            }
+        }
+
+        static slot *release(T *object) noexcept {
+            object->~T();
+            return new(static_cast<void *>(object)) slot();
+        }
+
+        // mutex must be held
+        void grow() {
+            slabs.emplace_back(new storage_t[slab_size]);
+            storage_t *slab = slabs.back().get();
+            for (std::size_t i = 0; i < slab_size; ++i) {
+                free.push_back(*new(static_cast<void *>(slab + i)) slot());
+            }
+            capacity.fetch_add(slab_size, std::memory_order_relaxed);
+        }
+
+        // to must be empty
+        void take(free_list &to, std::ptrdiff_t delta) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!full_batches.empty()) {
+                to = std::move(full_batches.back());
+                full_batches.pop_back();
+            } else {
+                while (free.size() < batch_size) {
+                    grow();
+                }
+                to.splice(to.end(), free, free.begin(), std::next(free.begin(), batch_size), batch_size);
+            }
+            account(delta);
+        }
+
+        void give_back(free_list &from, std::ptrdiff_t delta) noexcept {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (from.size() == batch_size) {
+                try {
+                    full_batches.push_back(std::move(from));
+                } catch (...) {
+                }
+            }
+            free.splice(free.begin(), from, from.begin(), from.end(), from.size());
+            account(delta);
+        }
+
+        void account(std::ptrdiff_t delta) noexcept {
+            std::ptrdiff_t now = in_use.fetch_add(delta, std::memory_order_relaxed) + delta;
+            std::ptrdiff_t peak = high_water.load(std::memory_order_relaxed);
+            while (now > peak && !high_water.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+        }
+
+        std::size_t const slab_size;
+        std::size_t const batch_size;
+
+        std::mutex mutex;
+        free_list free;
+        std::vector<free_list> full_batches;
+        std::vector<std::unique_ptr<storage_t[]>> slabs;
+
+        std::atomic<std::size_t> capacity{0};
+        std::atomic<std::ptrdiff_t> in_use{0};
+        std::atomic<std::ptrdiff_t> high_water{0};
+    };
+}
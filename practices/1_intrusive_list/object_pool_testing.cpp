@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "object_pool.h"
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct timer {
+        timer(int id, std::string name)
+                : id(id), name(std::move(name)) {
+            ++alive;
+        }
+
+        ~timer() {
+            --alive;
+        }
+
+        int id;
+        std::string name;
+
+        static std::atomic<int> alive;
+    };
+
+    std::atomic<int> timer::alive{0};
+
+    struct throwing {
+        explicit throwing(bool fail) {
+            if (fail)
+                throw std::runtime_error("ctor");
+        }
+    };
+}
+
+TEST(object_pool_testing, create_destroy) {
+    intrusive::object_pool<timer> pool(4);
+    timer *a = pool.create(1, "a");
+    timer *b = pool.create(2, "b");
+    EXPECT_EQ(1, a->id);
+    EXPECT_EQ("b", b->name);
+    EXPECT_EQ(2, timer::alive);
+    EXPECT_EQ(2, pool.stats().in_use);
+    EXPECT_EQ(4, pool.stats().capacity);
+    pool.destroy(a);
+    pool.destroy(b);
+    pool.destroy(nullptr);
+    EXPECT_EQ(0, timer::alive);
+    EXPECT_EQ(0, pool.stats().in_use);
+    EXPECT_EQ(2, pool.stats().high_water);
+}
+
+TEST(object_pool_testing, slots_are_reused) {
+    intrusive::object_pool<timer> pool(2);
+    timer *a = pool.create(1, "a");
+    pool.destroy(a);
+    timer *b = pool.create(2, "b");
+    EXPECT_EQ(a, b);
+    pool.destroy(b);
+    EXPECT_EQ(2, pool.stats().capacity);
+}
+
+TEST(object_pool_testing, grows_by_slabs) {
+    intrusive::object_pool<timer> pool(3);
+    std::vector<timer *> timers;
+    for (int i = 0; i < 7; ++i) {
+        timers.push_back(pool.create(i, "t"));
+    }
+    std::set<timer *> distinct(timers.begin(), timers.end());
+    EXPECT_EQ(7, distinct.size());
+    EXPECT_EQ(9, pool.stats().capacity);
+    EXPECT_EQ(7, pool.stats().in_use);
+    for (timer *t : timers) {
+        pool.destroy(t);
+    }
+    EXPECT_EQ(0, pool.stats().in_use);
+    EXPECT_EQ(7, pool.stats().high_water);
+}
+
+TEST(object_pool_testing, throwing_constructor) {
+    intrusive::object_pool<throwing> pool(1);
+    EXPECT_THROW(pool.create(true), std::runtime_error);
+    throwing *t = pool.create(false);
+    EXPECT_EQ(1, pool.stats().capacity);
+    pool.destroy(t);
+    EXPECT_EQ(0, pool.stats().in_use);
+}
+
+TEST(object_pool_testing, local_cache_batches) {
+    intrusive::object_pool<timer> pool(16, 4);
+    {
+        intrusive::object_pool<timer>::local_cache cache(pool);
+        timer *a = cache.create(1, "a");
+        EXPECT_EQ(3, cache.cached());
+        EXPECT_EQ(16, pool.stats().capacity);
+        std::vector<timer *> timers;
+        for (int i = 0; i < 8; ++i) {
+            timers.push_back(cache.create(i, "t"));
+        }
+        EXPECT_GE(pool.stats().in_use, 8);
+        for (timer *t : timers) {
+            cache.destroy(t);
+        }
+        EXPECT_LT(cache.cached(), 8);
+        cache.destroy(a);
+    }
+    EXPECT_EQ(0, timer::alive);
+    EXPECT_EQ(0, pool.stats().in_use);
+    EXPECT_GE(pool.stats().high_water, 8);
+    EXPECT_LE(pool.stats().high_water, 9);
+}
+
+TEST(object_pool_testing, local_caches_across_threads) {
+    intrusive::object_pool<timer> pool(64, 16);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, t] {
+            intrusive::object_pool<timer>::local_cache cache(pool);
+            std::vector<timer *> timers;
+            for (int round = 0; round < 100; ++round) {
+                for (int i = 0; i < 50; ++i) {
+                    timers.push_back(cache.create(t * 1000 + i, "t"));
+                }
+                for (int i = 0; i < 50; ++i) {
+                    EXPECT_EQ(t * 1000 + i, timers[i]->id);
+                    cache.destroy(timers[i]);
+                }
+                timers.clear();
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(0, timer::alive);
+    EXPECT_EQ(0, pool.stats().in_use);
+    EXPECT_LE(pool.stats().high_water, pool.stats().capacity);
+}
+
+TEST(object_pool_testing, cross_thread_destroy) {
+    intrusive::object_pool<timer> pool(8, 2);
+    std::vector<timer *> timers;
+    {
+        intrusive::object_pool<timer>::local_cache cache(pool);
+        for (int i = 0; i < 10; ++i) {
+            timers.push_back(cache.create(i, "t"));
+        }
+    }
+    std::thread([&pool, &timers] {
+        intrusive::object_pool<timer>::local_cache cache(pool);
+        for (timer *t : timers) {
+            cache.destroy(t);
+        }
+    }).join();
+    EXPECT_EQ(0, timer::alive);
+    EXPECT_EQ(0, pool.stats().in_use);
+}
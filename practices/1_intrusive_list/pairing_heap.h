@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+
+    struct default_tag;
+
+    // Hook of a pairing heap node: first child, next sibling and
+    // previous sibling (or parent for the first child, or itself for the root).
+    template<typename Tag = default_tag>
+    struct heap_element {
+
+        heap_element<Tag> *child = nullptr;
+        heap_element<Tag> *next = nullptr;
+        heap_element<Tag> *prev = nullptr;
+
+        heap_element<Tag>() = default;
+
+        heap_element(heap_element const &) = delete;
+
+        heap_element &operator=(heap_element const &) = delete;
+
+        bool is_linked() const noexcept {
+            return prev != nullptr;
+        }
+    };
+
+    // Min-heap: top() is an element that no other element compares less than by Cmp.
+    // push() and merge() are O(1), pop() and erase() are amortized O(log n),
+    // decrease_key() is O(1) (amortized o(log n)).
+    // An element must be erased from the heap before it is destroyed; Cmp must not throw.
+    template<typename T, typename Tag = default_tag, typename Cmp = std::less<T>>
+    struct pairing_heap {
+
+        static_assert(std::is_convertible_v<T &, heap_element<Tag> &>,
+                      "value type is not convertible to heap_element");
+
+        pairing_heap() noexcept = default;
+
+        explicit pairing_heap(Cmp cmp) noexcept: cmp(std::move(cmp)) {}
+
+        pairing_heap(pairing_heap const &) = delete;
+
+        pairing_heap(pairing_heap &&other) noexcept: root(other.root), count(other.count), cmp(std::move(other.cmp)) {
+            other.root = nullptr;
+            other.count = 0;
+        }
+
+        pairing_heap &operator=(pairing_heap const &) = delete;
+
+        pairing_heap &operator=(pairing_heap &&other) noexcept {
+            if (this != &other) {
+                clear();
+                root = other.root;
+                count = other.count;
+                cmp = std::move(other.cmp);
+                other.root = nullptr;
+                other.count = 0;
+            }
+            return *this;
+        }
+
+        ~pairing_heap() {
+            clear();
+        }
+
+        bool empty() const noexcept {
+            return root == nullptr;
+        }
+
+        std::size_t size() const noexcept {
+            return count;
+        }
+
+        T &top() noexcept {
+            return static_cast<T &>(*root);
+        }
+
+        T const &top() const noexcept {
+            return static_cast<T const &>(*root);
+        }
+
+        void push(T &el) {
+            heap_element<Tag> &element = el;
+            element.child = nullptr;
+            element.next = nullptr;
+            root = root == nullptr ? make_root(&element) : make_root(link(root, &element));
+            ++count;
+        }
+
+        void pop() {
+            heap_element<Tag> *old_root = root;
+            root = merge_pairs(old_root->child);
+            reset(old_root);
+            --count;
+        }
+
+        // Moves all elements of other into this heap. Both heaps must use equivalent comparators.
+        void merge(pairing_heap &other) {
+            if (&other == this || other.root == nullptr)
+                return;
+            root = root == nullptr ? other.root : make_root(link(root, other.root));
+            count += other.count;
+            other.root = nullptr;
+            other.count = 0;
+        }
+
+        // Must be called after the key of a linked element became smaller (or equal).
+        void decrease_key(T &el) {
+            heap_element<Tag> *element = &static_cast<heap_element<Tag> &>(el);
+            if (element == root)
+                return;
+            detach(element);
+            root = make_root(link(root, element));
+        }
+
+        // Must be called after the key of a linked element changed in any direction.
+        void update(T &el) {
+            erase(el);
+            push(el);
+        }
+
+        void erase(T &el) {
+            heap_element<Tag> *element = &static_cast<heap_element<Tag> &>(el);
+            if (element == root) {
+                pop();
+                return;
+            }
+            detach(element);
+            heap_element<Tag> *subtree = merge_pairs(element->child);
+            if (subtree != nullptr) {
+                root = make_root(link(root, subtree));
+            }
+            reset(element);
+            --count;
+        }
+
+        void clear() noexcept {
+            heap_element<Tag> *current = root;
+            while (current != nullptr) {
+                if (current->child != nullptr) {
+                    heap_element<Tag> *last_child = current->child;
+                    while (last_child->next != nullptr) {
+                        last_child = last_child->next;
+                    }
+                    last_child->next = current->next;
+                    current->next = current->child;
+                }
+                heap_element<Tag> *next = current->next;
+                reset(current);
+                current = next;
+            }
+            root = nullptr;
+            count = 0;
+        }
+
+    private:
+        bool less(heap_element<Tag> *a, heap_element<Tag> *b) {
+            return cmp(static_cast<T const &>(*a), static_cast<T const &>(*b));
+        }
+
+        // Links two roots: the larger one becomes the first child of the smaller one.
+        heap_element<Tag> *link(heap_element<Tag> *a, heap_element<Tag> *b) {
+            if (less(b, a)) {
+                std::swap(a, b);
+            }
+            b->prev = a;
+            b->next = a->child;
+            if (a->child != nullptr) {
+                a->child->prev = b;
+            }
+            a->child = b;
+            return a;
+        }
+
+        // Cuts the subtree rooted at a non-root element out of the heap.
+        void detach(heap_element<Tag> *element) noexcept {
+            if (element->prev->child == element) {
+                element->prev->child = element->next;
+            } else {
+                element->prev->next = element->next;
+            }
+            if (element->next != nullptr) {
+                element->next->prev = element->prev;
+            }
+            element->next = element->prev = nullptr;
+        }
+
+        // Standard two-pass pairing of a sibling list; returns the new subtree root or nullptr.
+        heap_element<Tag> *merge_pairs(heap_element<Tag> *first) {
+            heap_element<Tag> *pairs = nullptr;
+            while (first != nullptr) {
+                heap_element<Tag> *a = first;
+                heap_element<Tag> *b = a->next;
+                if (b == nullptr) {
+                    a->next = pairs;
+                    pairs = a;
+                    break;
+                }
+                first = b->next;
+                heap_element<Tag> *winner = link(a, b);
+                winner->next = pairs;
+                pairs = winner;
+            }
+            if (pairs == nullptr)
+                return nullptr;
+
+            heap_element<Tag> *result = pairs;
+            pairs = pairs->next;
+            while (pairs != nullptr) {
+                heap_element<Tag> *next = pairs->next;
+                result = link(result, pairs);
+                pairs = next;
+            }
+            return make_root(result);
+        }
+
+        static heap_element<Tag> *make_root(heap_element<Tag> *element) noexcept {
+            element->prev = element;
+            element->next = nullptr;
+            return element;
+        }
+
+        static void reset(heap_element<Tag> *element) noexcept {
+            element->child = element->next = element->prev = nullptr;
+        }
+
+        heap_element<Tag> *root = nullptr;
+        std::size_t count = 0;
+        Cmp cmp;
+    };
+}
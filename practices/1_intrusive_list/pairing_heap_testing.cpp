@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "pairing_heap.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+    struct task : intrusive::heap_element<> {
+        explicit task(int priority)
+                : priority(priority) {}
+
+        bool operator<(task const &other) const {
+            return priority < other.priority;
+        }
+
+        int priority;
+    };
+
+    using task_heap = intrusive::pairing_heap<task>;
+
+    std::vector<int> drain(task_heap &heap) {
+        std::vector<int> result;
+        while (!heap.empty()) {
+            result.push_back(heap.top().priority);
+            heap.pop();
+        }
+        return result;
+    }
+}
+
+TEST(pairing_heap_testing, default_ctor) {
+    task_heap heap;
+    EXPECT_TRUE(heap.empty());
+    EXPECT_EQ(0, heap.size());
+}
+
+TEST(pairing_heap_testing, push_pop) {
+    task_heap heap;
+    task a(5), b(1), c(4), d(2), e(3);
+    heap.push(a);
+    heap.push(b);
+    heap.push(c);
+    heap.push(d);
+    heap.push(e);
+    EXPECT_EQ(5, heap.size());
+    EXPECT_EQ(&b, &heap.top());
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), drain(heap));
+    EXPECT_FALSE(a.is_linked());
+    EXPECT_FALSE(b.is_linked());
+}
+
+TEST(pairing_heap_testing, custom_compare) {
+    auto greater = [](task const &x, task const &y) { return x.priority > y.priority; };
+    intrusive::pairing_heap<task, intrusive::default_tag, decltype(greater)> heap(greater);
+    task a(5), b(1), c(4);
+    heap.push(a);
+    heap.push(b);
+    heap.push(c);
+    EXPECT_EQ(5, heap.top().priority);
+    heap.pop();
+    EXPECT_EQ(4, heap.top().priority);
+}
+
+TEST(pairing_heap_testing, decrease_key) {
+    task_heap heap;
+    task a(5), b(1), c(4), d(2), e(3);
+    for (task *t : {&a, &b, &c, &d, &e}) {
+        heap.push(*t);
+    }
+    heap.pop();
+    c.priority = 0;
+    heap.decrease_key(c);
+    EXPECT_EQ(&c, &heap.top());
+    d.priority = -1;
+    heap.decrease_key(d);
+    EXPECT_EQ((std::vector<int>{-1, 0, 3, 5}), drain(heap));
+}
+
+TEST(pairing_heap_testing, erase) {
+    task_heap heap;
+    task a(5), b(1), c(4), d(2), e(3);
+    for (task *t : {&a, &b, &c, &d, &e}) {
+        heap.push(*t);
+    }
+    heap.pop();
+    heap.erase(c);
+    EXPECT_FALSE(c.is_linked());
+    heap.erase(d);
+    EXPECT_EQ(2, heap.size());
+    EXPECT_EQ((std::vector<int>{3, 5}), drain(heap));
+}
+
+TEST(pairing_heap_testing, update_increase) {
+    task_heap heap;
+    task a(1), b(2), c(3);
+    heap.push(a);
+    heap.push(b);
+    heap.push(c);
+    a.priority = 10;
+    heap.update(a);
+    EXPECT_EQ((std::vector<int>{2, 3, 10}), drain(heap));
+}
+
+TEST(pairing_heap_testing, merge) {
+    task_heap heap1, heap2;
+    task a(5), b(1), c(4), d(2), e(3);
+    heap1.push(a);
+    heap1.push(c);
+    heap2.push(b);
+    heap2.push(d);
+    heap2.push(e);
+    heap1.merge(heap2);
+    EXPECT_TRUE(heap2.empty());
+    EXPECT_EQ(5, heap1.size());
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), drain(heap1));
+}
+
+TEST(pairing_heap_testing, move_and_clear) {
+    task a(2), b(1);
+    task_heap heap1;
+    heap1.push(a);
+    heap1.push(b);
+    task_heap heap2 = std::move(heap1);
+    EXPECT_TRUE(heap1.empty());
+    EXPECT_EQ(&b, &heap2.top());
+    heap2.clear();
+    EXPECT_TRUE(heap2.empty());
+    EXPECT_FALSE(a.is_linked());
+    EXPECT_FALSE(b.is_linked());
+    heap1.push(a);
+    EXPECT_EQ(&a, &heap1.top());
+}
+
+TEST(pairing_heap_testing, randomized) {
+    std::mt19937 rng(7);
+    std::vector<std::unique_ptr<task>> tasks;
+    for (int i = 0; i < 2000; ++i) {
+        tasks.push_back(std::make_unique<task>(static_cast<int>(rng() % 1000)));
+    }
+    task_heap heap;
+    std::multiset<int> expected;
+    std::vector<task *> linked;
+    for (int step = 0; step < 20000; ++step) {
+        unsigned action = rng() % 5;
+        if (action <= 1 || linked.empty()) {
+            task *t = tasks[rng() % tasks.size()].get();
+            if (t->is_linked())
+                continue;
+            heap.push(*t);
+            expected.insert(t->priority);
+            linked.push_back(t);
+        } else if (action == 2) {
+            ASSERT_EQ(*expected.begin(), heap.top().priority);
+            task *t = &heap.top();
+            heap.pop();
+            expected.erase(expected.find(t->priority));
+            linked.erase(std::find(linked.begin(), linked.end(), t));
+        } else if (action == 3) {
+            std::size_t index = rng() % linked.size();
+            task *t = linked[index];
+            heap.erase(*t);
+            expected.erase(expected.find(t->priority));
+            linked.erase(linked.begin() + index);
+        } else {
+            task *t = linked[rng() % linked.size()];
+            expected.erase(expected.find(t->priority));
+            t->priority -= static_cast<int>(rng() % 100);
+            expected.insert(t->priority);
+            heap.decrease_key(*t);
+        }
+        ASSERT_EQ(expected.size(), heap.size());
+        if (!heap.empty()) {
+            ASSERT_EQ(*expected.begin(), heap.top().priority);
+        }
+    }
+    heap.clear();
+}
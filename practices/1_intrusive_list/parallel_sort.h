@@ -0,0 +1,91 @@
+#pragma once
+
+#include "intrusive_list.h"
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace intrusive {
+
+    namespace details {
+        template<typename Tasks>
+        void run_in_parallel(std::size_t count, Tasks tasks) {
+            std::vector<std::exception_ptr> errors(count);
+            std::vector<std::thread> workers;
+            workers.reserve(count - 1);
+            auto run = [&tasks, &errors](std::size_t i) {
+                try {
+                    tasks(i);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            };
+            for (std::size_t i = 1; i < count; ++i) {
+                try {
+                    workers.emplace_back(run, i);
+                } catch (...) {
+                    // joinable threads must not be destroyed
+                    for (std::thread &worker : workers) {
+                        worker.join();
+                    }
+                    throw;
+                }
+            }
+            run(0);
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+            for (std::exception_ptr &error : errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+    }
+
+    // Splits the list into threads chunks, sorts them on worker threads and merges
+    // them pairwise, also in parallel. Only relinks elements, like list::sort.
+    // Stable: chunks are contiguous and each merge takes equal elements from the left one first.
+    template<typename T, typename Tag, bool ConstantTimeSize, typename Compare>
+    void parallel_sort(list<T, Tag, ConstantTimeSize> &l, Compare cmp,
+                       std::size_t threads = std::thread::hardware_concurrency()) {
+        using list_t = list<T, Tag, ConstantTimeSize>;
+        std::size_t const min_chunk_size = 1024;
+
+        std::size_t size = l.size();
+        if (threads > size / min_chunk_size) {
+            threads = size / min_chunk_size;
+        }
+        if (threads <= 1) {
+            l.sort(cmp);
+            return;
+        }
+
+        std::vector<list_t> chunks(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            std::size_t chunk_size = size / threads + (i < size % threads ? 1 : 0);
+            auto last = std::next(l.begin(), chunk_size);
+            chunks[i].splice(chunks[i].end(), l, l.begin(), last, chunk_size);
+        }
+
+        try {
+            details::run_in_parallel(threads, [&chunks, &cmp](std::size_t i) {
+                chunks[i].sort(cmp);
+            });
+            for (std::size_t step = 1; step < threads; step *= 2) {
+                std::size_t merges = (threads - step + 2 * step - 1) / (2 * step);
+                details::run_in_parallel(merges, [&chunks, &cmp, step](std::size_t i) {
+                    std::size_t left = 2 * step * i;
+                    chunks[left].merge(chunks[left + step], cmp);
+                });
+            }
+        } catch (...) {
+            for (list_t &chunk : chunks) {
+                l.splice(l.end(), chunk, chunk.begin(), chunk.end());
+            }
+            throw;
+        }
+        l.swap(chunks[0]);
+    }
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+
+namespace intrusive {
+
+    struct default_tag;
+
+    template<typename T, typename Tag, typename Cmp, unsigned MaxHeight>
+    struct skip_list;
+
+    // Hook of skip_list with room for MaxHeight forward links stored inline; an element
+    // uses the first height of them, chosen at random on insertion. The low bit of a link
+    // marks the element as erased at that level. There is no auto-unlink.
+    template<typename Tag = default_tag, unsigned MaxHeight = 16>
+    struct skip_list_element {
+        static_assert(MaxHeight >= 1 && MaxHeight <= 32, "unsupported skip list height");
+
+        skip_list_element() = default;
+
+        skip_list_element(skip_list_element const &) = delete;
+
+        skip_list_element &operator=(skip_list_element const &) = delete;
+
+        bool is_linked() const noexcept {
+            return height != 0 && (next[0].load(std::memory_order_acquire) & 1) == 0;
+        }
+
+    private:
+        unsigned height = 0;
+        std::atomic<std::uintptr_t> next[MaxHeight] = {};
+
+        template<typename T, typename ListTag, typename Cmp, unsigned ListHeight>
+        friend struct skip_list;
+    };
+
+    // Ordered intrusive multiset that allows concurrent insert(), erase(), lookups and iteration
+    // (Herlihy and Shavit's lock-free skip list). insert() and erase() are lock-free;
+    // lower_bound(), find() and iteration never retry or help other threads and are wait-free
+    // as long as writers do not keep inserting ahead of them. Equal elements are ordered
+    // by address, so insert() always succeeds.
+    //
+    // The list does not reclaim memory: an erased element may still be visited by operations
+    // that started before erase() returned. It may be destroyed or inserted again only after
+    // both insert() and erase() of it returned and every operation running at that moment
+    // finished (e.g. with epochs or hazard pointers). The key of a linked element must not change.
+    template<typename T, typename Tag = default_tag, typename Cmp = std::less<>, unsigned MaxHeight = 16>
+    struct skip_list {
+        using hook_t = skip_list_element<Tag, MaxHeight>;
+
+        static_assert(std::is_convertible_v<T &, hook_t &>,
+                      "value type is not convertible to skip_list_element");
+
+        // Weakly consistent: visits the elements in order, skipping those erased before it reached them.
+        struct iterator {
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T *;
+            using reference = T &;
+
+            iterator() = default;
+
+            T &operator*() const noexcept {
+                return static_cast<T &>(*current);
+            }
+
+            T *operator->() const noexcept {
+                return static_cast<T *>(current);
+            }
+
+            iterator &operator++() & noexcept {
+                current = skip_erased(successor(current));
+                return *this;
+            }
+
+            iterator operator++(int) & noexcept {
+                iterator temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            bool operator==(iterator const &rhs) const & noexcept {
+                return current == rhs.current;
+            }
+
+            bool operator!=(iterator const &rhs) const & noexcept {
+                return current != rhs.current;
+            }
+
+            explicit iterator(hook_t *current) noexcept: current(current) {}
+
+            hook_t *current = nullptr;
+        };
+
+        skip_list() = default;
+
+        explicit skip_list(Cmp cmp) : cmp(std::move(cmp)) {}
+
+        skip_list(skip_list const &) = delete;
+
+        skip_list &operator=(skip_list const &) = delete;
+
+        // No other thread may use the list while it is destroyed.
+        ~skip_list() {
+            clear();
+        }
+
+        void insert(T &el) {
+            hook_t *element = &static_cast<hook_t &>(el);
+            unsigned height = random_height();
+            element->height = height;
+            hook_t *preds[MaxHeight];
+            hook_t *succs[MaxHeight];
+            for (;;) {
+                locate(element, preds, succs);
+                for (unsigned level = 0; level < height; ++level) {
+                    element->next[level].store(to_link(succs[level]), std::memory_order_relaxed);
+                }
+                std::uintptr_t expected = to_link(succs[0]);
+                if (preds[0]->next[0].compare_exchange_strong(expected, to_link(element),
+                                                              std::memory_order_release, std::memory_order_relaxed))
+                    break;
+            }
+            // the element is in the list now; the upper levels are only shortcuts to it
+            for (unsigned level = 1; level < height; ++level) {
+                for (;;) {
+                    std::uintptr_t link = element->next[level].load(std::memory_order_acquire);
+                    // a concurrent erase() marks the link, so it must not be overwritten blindly
+                    if (is_marked(link) || (link != to_link(succs[level]) &&
+                                            !element->next[level].compare_exchange_strong(link, to_link(succs[level]))))
+                        break;
+                    std::uintptr_t expected = to_link(succs[level]);
+                    if (preds[level]->next[level].compare_exchange_strong(expected, to_link(element)))
+                        break;
+                    locate(element, preds, succs);
+                }
+                if (is_marked(element->next[level].load(std::memory_order_acquire)))
+                    break;
+            }
+            // erase() could have finished before the element got linked at an upper level
+            if (is_marked(element->next[0].load(std::memory_order_acquire))) {
+                locate(element, preds, succs);
+            }
+        }
+
+        // Returns false if the element has already been erased by another call.
+        bool erase(T &el) {
+            hook_t *element = &static_cast<hook_t &>(el);
+            for (unsigned level = element->height; level-- > 1;) {
+                std::uintptr_t link = element->next[level].load(std::memory_order_acquire);
+                while (!is_marked(link) && !element->next[level].compare_exchange_weak(link, link | 1)) {}
+            }
+            std::uintptr_t link = element->next[0].load(std::memory_order_acquire);
+            do {
+                if (is_marked(link))
+                    return false;
+            } while (!element->next[0].compare_exchange_weak(link, link | 1));
+
+            hook_t *preds[MaxHeight];
+            hook_t *succs[MaxHeight];
+            locate(element, preds, succs);
+            return true;
+        }
+
+        // The first element that does not compare less than key, or nullptr.
+        template<typename K>
+        T *lower_bound(K const &key) const noexcept {
+            hook_t const *pred = &head;
+            hook_t *current = nullptr;
+            for (unsigned level = MaxHeight; level-- > 0;) {
+                current = to_element(pred->next[level].load(std::memory_order_acquire));
+                while (current != nullptr) {
+                    std::uintptr_t succ = current->next[level].load(std::memory_order_acquire);
+                    if (!is_marked(succ)) {
+                        if (!cmp(static_cast<T const &>(*current), key))
+                            break;
+                        pred = current;
+                    }
+                    current = to_element(succ);
+                }
+            }
+            return current == nullptr ? nullptr : static_cast<T *>(current);
+        }
+
+        // An element equivalent to key, or nullptr. Cmp must also accept (key, element).
+        template<typename K>
+        T *find(K const &key) const noexcept {
+            T *result = lower_bound(key);
+            return result != nullptr && !cmp(key, *result) ? result : nullptr;
+        }
+
+        iterator begin() noexcept {
+            return iterator(skip_erased(successor(&head)));
+        }
+
+        iterator end() noexcept {
+            return iterator();
+        }
+
+        bool empty() const noexcept {
+            return skip_erased(successor(&head)) == nullptr;
+        }
+
+        std::size_t size() const noexcept {
+            std::size_t result = 0;
+            for (iterator it(const_cast<skip_list *>(this)->begin()); it != iterator(); ++it) {
+                ++result;
+            }
+            return result;
+        }
+
+        // Not thread-safe.
+        void clear() noexcept {
+            hook_t *current = to_element(head.next[0].load(std::memory_order_relaxed));
+            while (current != nullptr) {
+                hook_t *next = to_element(current->next[0].load(std::memory_order_relaxed));
+                current->height = 0;
+                for (auto &link : current->next) {
+                    link.store(0, std::memory_order_relaxed);
+                }
+                current = next;
+            }
+            for (auto &link : head.next) {
+                link.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        static bool is_marked(std::uintptr_t link) noexcept {
+            return (link & 1) != 0;
+        }
+
+        static hook_t *to_element(std::uintptr_t link) noexcept {
+            return reinterpret_cast<hook_t *>(link & ~std::uintptr_t(1));
+        }
+
+        static std::uintptr_t to_link(hook_t *element) noexcept {
+            return reinterpret_cast<std::uintptr_t>(element);
+        }
+
+        static hook_t *successor(hook_t const *element) noexcept {
+            return to_element(element->next[0].load(std::memory_order_acquire));
+        }
+
+        static hook_t *skip_erased(hook_t *element) noexcept {
+            while (element != nullptr) {
+                std::uintptr_t next = element->next[0].load(std::memory_order_acquire);
+                if (!is_marked(next))
+                    break;
+                element = to_element(next);
+            }
+            return element;
+        }
+
+        // Geometric with p = 1/4.
+        static unsigned random_height() noexcept {
+            thread_local std::uint64_t state =
+                    (std::hash<std::thread::id>()(std::this_thread::get_id()) + 1) * 0x9E3779B97F4A7C15ull;
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            unsigned height = 1;
+            for (std::uint64_t bits = state; height < MaxHeight && (bits & 3) == 0; bits >>= 2) {
+                ++height;
+            }
+            return height;
+        }
+
+        bool less(hook_t const *a, hook_t const *b) const {
+            T const &x = static_cast<T const &>(*a);
+            T const &y = static_cast<T const &>(*b);
+            if (cmp(x, y))
+                return true;
+            if (cmp(y, x))
+                return false;
+            return std::less<hook_t const *>()(a, b);
+        }
+
+        // Fills preds and succs with the neighbours of target at every level
+        // and unlinks the erased elements it passes.
+        void locate(hook_t const *target, hook_t **preds, hook_t **succs) {
+            while (!try_locate(target, preds, succs)) {}
+        }
+
+        bool try_locate(hook_t const *target, hook_t **preds, hook_t **succs) {
+            hook_t *pred = &head;
+            for (unsigned level = MaxHeight; level-- > 0;) {
+                hook_t *current = to_element(pred->next[level].load(std::memory_order_acquire));
+                while (current != nullptr) {
+                    std::uintptr_t succ = current->next[level].load(std::memory_order_acquire);
+                    if (is_marked(succ)) {
+                        std::uintptr_t expected = to_link(current);
+                        if (!pred->next[level].compare_exchange_strong(expected, succ & ~std::uintptr_t(1)))
+                            return false;
+                        current = to_element(succ);
+                        continue;
+                    }
+                    if (!less(current, target))
+                        break;
+                    pred = current;
+                    current = to_element(succ);
+                }
+                preds[level] = pred;
+                succs[level] = current;
+            }
+            return true;
+        }
+
+        hook_t head;
+        Cmp cmp;
+    };
+}
@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include "skip_list.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct tag_by_key;
+    struct tag_by_id;
+
+    struct session : intrusive::skip_list_element<tag_by_key>, intrusive::skip_list_element<tag_by_id> {
+        session(int key, int id)
+                : key(key), id(id) {}
+
+        int key;
+        int id;
+    };
+
+    struct by_key {
+        bool operator()(session const &a, session const &b) const {
+            return a.key < b.key;
+        }
+
+        bool operator()(session const &a, int b) const {
+            return a.key < b;
+        }
+
+        bool operator()(int a, session const &b) const {
+            return a < b.key;
+        }
+    };
+
+    struct by_id {
+        bool operator()(session const &a, session const &b) const {
+            return a.id < b.id;
+        }
+
+        bool operator()(session const &a, int b) const {
+            return a.id < b;
+        }
+
+        bool operator()(int a, session const &b) const {
+            return a < b.id;
+        }
+    };
+
+    using key_list = intrusive::skip_list<session, tag_by_key, by_key>;
+    using id_list = intrusive::skip_list<session, tag_by_id, by_id>;
+
+    std::vector<int> keys(key_list &list) {
+        std::vector<int> result;
+        for (session const &s : list) {
+            result.push_back(s.key);
+        }
+        return result;
+    }
+
+    struct node : intrusive::skip_list_element<intrusive::default_tag, 4> {
+        explicit node(int value)
+                : value(value) {}
+
+        int value;
+    };
+
+    struct node_less {
+        bool operator()(node const &a, node const &b) const {
+            return a.value < b.value;
+        }
+
+        bool operator()(node const &a, int b) const {
+            return a.value < b;
+        }
+
+        bool operator()(int a, node const &b) const {
+            return a < b.value;
+        }
+    };
+}
+
+TEST(skip_list_testing, hook_is_inline) {
+    using hook = intrusive::skip_list_element<intrusive::default_tag, 4>;
+    EXPECT_GE(sizeof(hook), 4 * sizeof(void *));
+    EXPECT_LE(sizeof(hook), 5 * sizeof(void *));
+}
+
+TEST(skip_list_testing, insert_keeps_order) {
+    std::deque<session> sessions;
+    key_list list;
+    for (int key : {5, 1, 4, 2, 3, 9, 0, 7, 8, 6}) {
+        sessions.emplace_back(key, key);
+        list.insert(sessions.back());
+    }
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), keys(list));
+    EXPECT_EQ(10, list.size());
+    EXPECT_FALSE(list.empty());
+    EXPECT_TRUE(sessions.front().intrusive::skip_list_element<tag_by_key>::is_linked());
+}
+
+TEST(skip_list_testing, equal_keys) {
+    std::deque<session> sessions;
+    key_list list;
+    for (int i = 0; i < 6; ++i) {
+        sessions.emplace_back(i % 2, i);
+        list.insert(sessions.back());
+    }
+    EXPECT_EQ(std::vector<int>({0, 0, 0, 1, 1, 1}), keys(list));
+    EXPECT_TRUE(list.erase(sessions[2]));
+    EXPECT_EQ(std::vector<int>({0, 0, 1, 1, 1}), keys(list));
+}
+
+TEST(skip_list_testing, lower_bound_and_find) {
+    std::deque<session> sessions;
+    key_list list;
+    EXPECT_EQ(nullptr, list.lower_bound(0));
+    for (int key = 0; key < 100; key += 10) {
+        sessions.emplace_back(key, key);
+        list.insert(sessions.back());
+    }
+    EXPECT_EQ(0, list.lower_bound(-5)->key);
+    EXPECT_EQ(20, list.lower_bound(20)->key);
+    EXPECT_EQ(30, list.lower_bound(21)->key);
+    EXPECT_EQ(nullptr, list.lower_bound(91));
+    EXPECT_EQ(&sessions[4], list.find(40));
+    EXPECT_EQ(nullptr, list.find(41));
+}
+
+TEST(skip_list_testing, erase) {
+    std::deque<session> sessions;
+    key_list list;
+    for (int key = 0; key < 5; ++key) {
+        sessions.emplace_back(key, key);
+        list.insert(sessions.back());
+    }
+    EXPECT_TRUE(list.erase(sessions[2]));
+    EXPECT_FALSE(list.erase(sessions[2]));
+    EXPECT_FALSE(sessions[2].intrusive::skip_list_element<tag_by_key>::is_linked());
+    EXPECT_EQ(nullptr, list.find(2));
+    EXPECT_EQ(3, list.lower_bound(2)->key);
+    EXPECT_TRUE(list.erase(sessions[0]));
+    EXPECT_TRUE(list.erase(sessions[4]));
+    EXPECT_EQ(std::vector<int>({1, 3}), keys(list));
+}
+
+TEST(skip_list_testing, reinsert_after_erase) {
+    session a(1, 1), b(2, 2);
+    key_list list;
+    list.insert(a);
+    list.insert(b);
+    list.erase(a);
+    a.key = 3;
+    list.insert(a);
+    EXPECT_EQ(std::vector<int>({2, 3}), keys(list));
+}
+
+TEST(skip_list_testing, clear) {
+    session a(1, 1), b(2, 2);
+    {
+        key_list list;
+        list.insert(a);
+        list.insert(b);
+        list.clear();
+        EXPECT_TRUE(list.empty());
+        EXPECT_FALSE(a.intrusive::skip_list_element<tag_by_key>::is_linked());
+        list.insert(a);
+    }
+    EXPECT_FALSE(a.intrusive::skip_list_element<tag_by_key>::is_linked());
+}
+
+TEST(skip_list_testing, multiple_tags) {
+    std::deque<session> sessions;
+    key_list by_key_list;
+    id_list by_id_list;
+    for (int i = 0; i < 5; ++i) {
+        sessions.emplace_back(10 - i, i);
+        by_key_list.insert(sessions.back());
+        by_id_list.insert(sessions.back());
+    }
+    EXPECT_EQ(std::vector<int>({6, 7, 8, 9, 10}), keys(by_key_list));
+    EXPECT_EQ(&sessions[0], by_id_list.find(0));
+    by_key_list.erase(sessions[0]);
+    EXPECT_EQ(&sessions[0], by_id_list.find(0));
+    EXPECT_EQ(nullptr, by_key_list.find(10));
+}
+
+TEST(skip_list_testing, many_elements) {
+    std::deque<node> nodes;
+    intrusive::skip_list<node, intrusive::default_tag, node_less, 4> list;
+    for (int i = 0; i < 1000; ++i) {
+        nodes.emplace_back((i * 7919) % 1000);
+        list.insert(nodes.back());
+    }
+    int expected = 0;
+    for (node const &n : list) {
+        EXPECT_EQ(expected++, n.value);
+    }
+    EXPECT_EQ(1000, expected);
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(list.erase(*list.find(i)));
+    }
+    EXPECT_EQ(500, list.size());
+    EXPECT_EQ(501, list.lower_bound(500)->value);
+}
+
+// Writers insert their own elements and then all race to erase the odd ones
+// while readers search and iterate. Elements are not reused until all threads finish.
+TEST(skip_list_testing, concurrent_readers_and_writers) {
+    int const writers = 4;
+    int const readers = 2;
+    int const per_writer = 2000;
+    std::deque<node> nodes;
+    for (int i = 0; i < writers * per_writer; ++i) {
+        nodes.emplace_back(i);
+    }
+    intrusive::skip_list<node, intrusive::default_tag, node_less, 4> list;
+    std::atomic<bool> done{false};
+    std::atomic<int> inserted{0};
+    std::atomic<int> erased{0};
+    std::atomic<int> errors{0};
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            for (int i = 0; i < per_writer; ++i) {
+                list.insert(nodes[i * writers + w]);
+            }
+            ++inserted;
+            while (inserted.load() != writers) {
+                std::this_thread::yield();
+            }
+            for (int i = 1; i < writers * per_writer; i += 2) {
+                if (list.erase(nodes[i])) {
+                    ++erased;
+                }
+            }
+        });
+    }
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            while (!done.load()) {
+                int previous = -1;
+                for (node const &n : list) {
+                    if (n.value <= previous) {
+                        ++errors;
+                    }
+                    previous = n.value;
+                }
+                node const *found = list.lower_bound(writers * per_writer / 2);
+                if (found != nullptr && found->value < writers * per_writer / 2) {
+                    ++errors;
+                }
+            }
+        });
+    }
+    for (int w = 0; w < writers; ++w) {
+        threads[w].join();
+    }
+    done = true;
+    for (int r = 0; r < readers; ++r) {
+        threads[writers + r].join();
+    }
+
+    EXPECT_EQ(0, errors.load());
+    EXPECT_EQ(writers * per_writer / 2, erased.load());
+    std::vector<int> values;
+    for (node const &n : list) {
+        values.push_back(n.value);
+    }
+    ASSERT_EQ(std::size_t(writers * per_writer / 2), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(int(2 * i), values[i]);
+    }
+}
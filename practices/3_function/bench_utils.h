@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE
+#endif
+
+namespace bench {
+
+    template<typename T>
+    void do_not_optimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile char const *sink;
+        sink = reinterpret_cast<char const volatile *>(&value);
+#endif
+    }
+
+    // Runs setup() and then f() repeats times and returns the best time of f() in nanoseconds.
+    template<typename Setup, typename F>
+    double measure_ns(std::size_t repeats, Setup &&setup, F &&f) {
+        double best = 0;
+        for (std::size_t i = 0; i < repeats; ++i) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto finish = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double, std::nano>(finish - start).count();
+            if (i == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        return best;
+    }
+
+    // Incremented by the replacement operator new of the benchmark executable.
+    inline std::atomic<std::size_t> &allocation_counter() {
+        static std::atomic<std::size_t> counter{0};
+        return counter;
+    }
+
+    inline std::size_t allocations() {
+        return allocation_counter().load(std::memory_order_relaxed);
+    }
+
+    struct result {
+        std::string name;
+        std::size_t items;
+        double ns;
+        double allocations_per_item;
+    };
+
+    // Collects the results of a run. Names are slash-separated paths with "key:value"
+    // parameters, e.g. "invoke/function/capture:32/inline:16".
+    struct reporter {
+        bool json = false;
+        std::vector<result> results;
+        // Settings of the run, written to the context so that only comparable runs are compared.
+        std::vector<std::pair<std::string, std::size_t>> parameters;
+
+        // Human-readable output goes to stderr when stdout is taken by JSON.
+        std::FILE *log() const noexcept {
+            return json ? stderr : stdout;
+        }
+
+        void add(std::string name, std::size_t items, double ns, double allocations_per_item) {
+            std::fprintf(log(), "%-64s %10zu items %12.3f ms %8.2f ns/item %6.2f allocs/item\n",
+                         name.c_str(), items, ns / 1e6, ns / items, allocations_per_item);
+            results.push_back({std::move(name), items, ns, allocations_per_item});
+        }
+
+        void write_json(std::FILE *out) const {
+            std::fprintf(out, "{\n  \"context\": {\n");
+#if defined(__VERSION__)
+            std::fprintf(out, "    \"compiler\": \"%s\",\n", escape(__VERSION__).c_str());
+#endif
+#if defined(NDEBUG)
+            std::fprintf(out, "    \"assertions\": false,\n");
+#else
+            std::fprintf(out, "    \"assertions\": true,\n");
+#endif
+            for (auto const &parameter : parameters) {
+                std::fprintf(out, "    \"%s\": %zu,\n", escape(parameter.first).c_str(), parameter.second);
+            }
+            std::fprintf(out, "    \"hardware_concurrency\": %u\n  },\n  \"benchmarks\": [", std::thread::hardware_concurrency());
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                result const &r = results[i];
+                std::fprintf(out, "%s\n    {\"name\": \"%s\", \"items\": %zu, \"time_ns\": %.1f, \"ns_per_item\": %.3f, "
+                                  "\"allocations_per_item\": %.3f}",
+                             i == 0 ? "" : ",", escape(r.name).c_str(), r.items, r.ns, r.ns / r.items,
+                             r.allocations_per_item);
+            }
+            std::fprintf(out, "\n  ]\n}\n");
+        }
+
+    private:
+        static std::string escape(std::string const &s) {
+            std::string escaped;
+            for (char c : s) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                }
+                escaped += c;
+            }
+            return escaped;
+        }
+    };
+
+    inline reporter &current_reporter() {
+        static reporter instance;
+        return instance;
+    }
+
+    inline std::FILE *log() {
+        return current_reporter().log();
+    }
+
+    inline void report(std::string name, std::size_t n, double ns, double allocations_per_item = 0) {
+        current_reporter().add(std::move(name), n, ns, allocations_per_item);
+    }
+
+    // Like measure_ns(), but also reports how many allocations f() made per item on average.
+    template<typename Setup, typename F>
+    void measure_and_report(std::string name, std::size_t items, std::size_t repeats, Setup &&setup, F &&f) {
+        std::size_t allocated = 0;
+        double ns = measure_ns(repeats, [&] {
+            setup();
+            allocated -= allocations();
+        }, [&] {
+            f();
+            allocated += allocations();
+        });
+        report(std::move(name), items, ns, static_cast<double>(allocated) / repeats / items);
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+// Memory resource for callables that function stores on the heap. Blocks of up to max_size bytes
+// are rounded up to a multiple of granularity and recycled through a free list per size class;
+// larger or over-aligned ones come from upstream. Memory goes back to upstream only on release()
+// or destruction. Not thread-safe: use one pool per thread or std::pmr::synchronized_pool_resource.
+struct callable_pool : std::pmr::memory_resource {
+    static constexpr std::size_t granularity = alignof(std::max_align_t);
+    static constexpr std::size_t max_size = 512;
+    static constexpr std::size_t chunk_size = 64 * 1024;
+
+    explicit callable_pool(std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) noexcept
+            : upstream(upstream) {}
+
+    callable_pool(callable_pool const &) = delete;
+
+    callable_pool &operator=(callable_pool const &) = delete;
+
+    ~callable_pool() override {
+        release();
+    }
+
+    // Frees all memory taken from upstream, including blocks that were not deallocated.
+    void release() noexcept {
+        while (chunks != nullptr) {
+            chunk *next = chunks->next;
+            upstream->deallocate(chunks, chunk_size, granularity);
+            chunks = next;
+        }
+        for (free_block *&list : free_lists) {
+            list = nullptr;
+        }
+        current = nullptr;
+        end = nullptr;
+    }
+
+    std::pmr::memory_resource *upstream_resource() const noexcept {
+        return upstream;
+    }
+
+private:
+    struct free_block {
+        free_block *next;
+    };
+
+    // Header of a chunk taken from upstream, padded so that blocks after it stay aligned.
+    struct alignas(granularity) chunk {
+        chunk *next;
+    };
+
+    static bool pooled(std::size_t bytes, std::size_t alignment) noexcept {
+        return bytes <= max_size && alignment <= granularity;
+    }
+
+    static std::size_t size_class(std::size_t bytes) noexcept {
+        return bytes == 0 ? 0 : (bytes - 1) / granularity;
+    }
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!pooled(bytes, alignment))
+            return upstream->allocate(bytes, alignment);
+
+        std::size_t index = size_class(bytes);
+        if (free_block *block = free_lists[index]) {
+            free_lists[index] = block->next;
+            return block;
+        }
+        std::size_t rounded = (index + 1) * granularity;
+        if (static_cast<std::size_t>(end - current) < rounded) {
+            refill();
+        }
+        void *result = current;
+        current += rounded;
+        return result;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+        if (!pooled(bytes, alignment)) {
+            upstream->deallocate(p, bytes, alignment);
+            return;
+        }
+        std::size_t index = size_class(bytes);
+        free_lists[index] = new(p) free_block{free_lists[index]};
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override {
+        return this == &other;
+    }
+
+    // The rest of the current chunk is dropped; it is at most max_size bytes.
+    void refill() {
+        void *memory = upstream->allocate(chunk_size, granularity);
+        chunks = new(memory) chunk{chunks};
+        current = reinterpret_cast<char *>(chunks + 1);
+        end = static_cast<char *>(memory) + chunk_size;
+    }
+
+    std::pmr::memory_resource *upstream;
+    free_block *free_lists[max_size / granularity] = {};
+    chunk *chunks = nullptr;
+    char *current = nullptr;
+    char *end = nullptr;
+};
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <type_traits>
 #include <exception>
 
@@ -9,11 +15,38 @@ struct bad_function_call : std::exception {
     }
 };
 
-template<typename T>
-constexpr bool is_small_v = sizeof(T) <= sizeof(void *)
-                            && (alignof(void *) % alignof(T) == 0)
+// Whether T is stored in the inline buffer of Size bytes aligned to Align instead of on the heap.
+template<typename T, std::size_t Size = sizeof(void *), std::size_t Align = alignof(void *)>
+constexpr bool is_small_v = sizeof(T) <= Size
+                            && (Align % alignof(T) == 0)
                             && std::is_nothrow_move_constructible<T>::value;
 
+// Bytes of the inline buffer taken by a T, or by the pointer to it if it is stored on the heap.
+template<typename T, std::size_t Size = sizeof(void *), std::size_t Align = alignof(void *)>
+constexpr std::size_t inline_size_v = is_small_v<T, Size, Align> ? sizeof(T) : sizeof(void *);
+
+// Identifies the type of a stored callable: the address of a variable of which there is one per type.
+// It does not depend on the signature or on where the callable is stored, so target<T>() compares it
+// once instead of looking up every descriptor T may have. Unlike typeid, it works without RTTI.
+using type_id_t = void const *;
+
+template<typename T>
+struct type_tag {
+    // Not const, so that the linker cannot fold the ids of different types into one.
+    static inline char id = 0;
+};
+
+template<typename T>
+constexpr type_id_t type_id() noexcept {
+    return &type_tag<T>::id;
+}
+
+template<typename R, typename... Args>
+struct descriptor;
+
+template<typename R, typename... Args>
+descriptor<R, Args...> const *get_empty_descriptor();
+
 template<typename R, typename... Args>
 struct descriptor {
     using invoke_fn_t = R (*)(void *, Args &&...);
@@ -25,10 +58,19 @@ struct descriptor {
 
     invoke_fn_t invoke;
     delete_obj_fn_t delete_obj;
+    // nullptr for callables stored by move_only_function, which are never copied.
     copy_constructor_fn_t copy_constructor;
     move_constructor_fn_t move_constructor;
     target_fn_t target;
     const_target_fn_t const_target;
+    // type_id of the callable, type_id<void>() if there is none.
+    type_id_t type;
+    // Whether the object can be moved by copying the buffer and forgetting the source.
+    bool relocatable;
+
+    static descriptor const *empty() {
+        return get_empty_descriptor<R, Args...>();
+    }
 };
 
 template<typename R, typename... Args>
@@ -48,17 +90,62 @@ descriptor<R, Args...> const *get_empty_descriptor() {
             },
             [](void const *) -> void const * { // const_target
                 return nullptr;
-            }
+            },
+            type_id<void>(), // type
+            true // relocatable
     };
 
     return &table;
 }
 
-template<typename T, bool isSmall>
+// A callable stored on the heap, along with the resource it was allocated from.
+template<typename T>
+struct heap_object {
+    template<typename... A>
+    static heap_object *create(std::pmr::memory_resource *resource, A &&... args) {
+        void *memory = resource->allocate(sizeof(heap_object), alignof(heap_object));
+        try {
+            return new(memory) heap_object(resource, std::forward<A>(args)...);
+        } catch (...) {
+            resource->deallocate(memory, sizeof(heap_object), alignof(heap_object));
+            throw;
+        }
+    }
+
+    static void destroy(heap_object *obj) noexcept {
+        std::pmr::memory_resource *resource = obj->resource;
+        obj->~heap_object();
+        resource->deallocate(obj, sizeof(heap_object), alignof(heap_object));
+    }
+
+    std::pmr::memory_resource *resource;
+    T value;
+
+private:
+    template<typename... A>
+    heap_object(std::pmr::memory_resource *resource, A &&... args)
+            : resource(resource), value(std::forward<A>(args)...) {}
+};
+
+// Descriptors of T stored inline or on the heap. Unless isCopyable, copy_constructor is nullptr,
+// so that T need not be copy constructible.
+template<typename T, bool isSmall, bool isCopyable = true>
 struct object_traits;
 
-template<typename T>
-struct object_traits<T, true> {
+using copy_constructor_fn_t = void (*)(void *dest, void const *src);
+
+template<typename T, bool isCopyable>
+struct object_traits<T, true, isCopyable> {
+    static constexpr copy_constructor_fn_t copy_constructor() {
+        if constexpr (isCopyable) {
+            return [](void *dest, void const *src) {
+                new(dest) T(*static_cast<T const *>(src));
+            };
+        } else {
+            return nullptr;
+        }
+    }
+
     template<typename R, typename... Args>
     descriptor<R, Args...> const *get_type_descriptor() {
         static constexpr descriptor<R, Args...> table{
@@ -68,61 +155,138 @@ struct object_traits<T, true> {
                 [](void *obj) { // delete_obj
                     static_cast<T *>(obj)->~T();
                 },
-                [](void *dest, void const *src) { // copy_constructor
-                    new(dest) T(*static_cast<T const *>(src));
-                },
-                [](void *dest, void *src) { // move_constructor
+                copy_constructor(), // copy_constructor
+                [](void *dest, void *src) { // move_constructor, destroys src
                     new(dest) T(std::move(*static_cast<T *>(src)));
+                    static_cast<T *>(src)->~T();
                 },
                 [](void *obj) -> void * { // target
                     return obj;
                 },
                 [](void const *obj) -> void const * { // const_target
                     return obj;
-                }
+                },
+                type_id<T>(), // type
+                std::is_trivially_copyable_v<T> // relocatable
         };
         return &table;
     }
 };
 
-template<typename T>
-struct object_traits<T, false> {
+template<typename T, bool isCopyable>
+struct object_traits<T, false, isCopyable> {
+    // From the resource of src.
+    static constexpr copy_constructor_fn_t copy_constructor() {
+        if constexpr (isCopyable) {
+            return [](void *dest, void const *src) {
+                heap_object<T> const *source = *static_cast<heap_object<T> *const *>(src);
+                heap_object<T> *&ref_to_dest = *static_cast<heap_object<T> **>(dest);
+                ref_to_dest = heap_object<T>::create(source->resource, source->value);
+            };
+        } else {
+            return nullptr;
+        }
+    }
+
     template<typename R, typename... Args>
     descriptor<R, Args...> const *get_type_descriptor() const {
         static constexpr descriptor<R, Args...> table{
                 [](void *obj, Args &&... args) -> R { // invoke
-                    return (**(static_cast<T **>(obj)))(std::forward<Args>(args)...);
+                    return (*static_cast<heap_object<T> **>(obj))->value(std::forward<Args>(args)...);
                 },
                 [](void *obj) { // delete_obj
-                    delete *static_cast<T **>(obj);
-                },
-                [](void *dest, void const *src) { // copy_constructor
-                    T *&ref_to_dest = *static_cast<T **>(dest);
-                    ref_to_dest = new T(**static_cast<T *const *>(src));
+                    heap_object<T>::destroy(*static_cast<heap_object<T> **>(obj));
                 },
+                copy_constructor(), // copy_constructor
                 [](void *dest, void *src) { // move constructor
-                    T *&ref_to_dest = *static_cast<T **>(dest);
-                    ref_to_dest = *static_cast<T **>(src);
+                    heap_object<T> *&ref_to_dest = *static_cast<heap_object<T> **>(dest);
+                    ref_to_dest = *static_cast<heap_object<T> **>(src);
                 },
                 [](void *obj) -> void * { // target
-                    return *static_cast<T **>(obj);
+                    return &(*static_cast<heap_object<T> **>(obj))->value;
                 },
                 [](void const *obj) -> void const * { // const_target
-                    return *static_cast<T *const *>(obj);
-                }
+                    return &(*static_cast<heap_object<T> *const *>(obj))->value;
+                },
+                type_id<T>(), // type
+                true // relocatable
         };
         return &table;
     }
 };
 
-template<typename R, typename... Args>
+// Opt-in for function: the callable is stored once and copies share it instead of copying it.
+struct shared_storage_t {
+    explicit shared_storage_t() = default;
+};
+
+inline constexpr shared_storage_t shared_storage{};
+
+// A callable shared by copies of a function, destroyed along with the last of them.
+template<typename T>
+struct shared_object {
+    explicit shared_object(T &&value) : value(std::move(value)) {}
+
+    std::atomic<std::size_t> references{1};
+    T const value;
+};
+
+template<typename T>
+struct shared_object_traits {
+    template<typename R, typename... Args>
+    static descriptor<R, Args...> const *get_type_descriptor() {
+        using object_t = heap_object<shared_object<T>>;
+        static constexpr descriptor<R, Args...> table{
+                [](void *obj, Args &&... args) -> R { // invoke
+                    return (*static_cast<object_t **>(obj))->value.value(std::forward<Args>(args)...);
+                },
+                [](void *obj) { // delete_obj
+                    object_t *shared = *static_cast<object_t **>(obj);
+                    if (shared->value.references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        object_t::destroy(shared);
+                    }
+                },
+                [](void *dest, void const *src) { // copy_constructor, shares src
+                    object_t *shared = *static_cast<object_t *const *>(src);
+                    shared->value.references.fetch_add(1, std::memory_order_relaxed);
+                    *static_cast<object_t **>(dest) = shared;
+                },
+                [](void *dest, void *src) { // move constructor
+                    *static_cast<object_t **>(dest) = *static_cast<object_t **>(src);
+                },
+                [](void *) -> void * { // target, the callable is immutable
+                    return nullptr;
+                },
+                [](void const *obj) -> void const * { // const_target
+                    return &(*static_cast<object_t *const *>(obj))->value.value;
+                },
+                type_id<T>(), // type
+                true // relocatable
+        };
+        return &table;
+    }
+};
+
+// Buffer and descriptor of a type-erased callable. A storage whose descriptors may lack
+// copy_constructor, like that of move_only_function, must not be copied.
+// The invoke entry is also kept next to the buffer, so a call does not load the descriptor.
+template<std::size_t Size, std::size_t Align, typename R, typename... Args>
 struct storage {
+    using buffer_t = typename std::aligned_storage<Size, Align>::type;
 
-    storage(const descriptor<R, Args...> *descriptor) : descr(descriptor) {}
+    using invoke_fn_t = R (*)(void *, Args &&...);
 
-    storage(storage const &other) {
+    // relocate() copies the whole buffer, so the bytes past the first used ones, which the callable
+    // leaves alone, are zeroed.
+    explicit storage(const descriptor<R, Args...> *descriptor, std::size_t used = 0)
+            : descr(descriptor), invoker(descriptor->invoke) {
+        std::memset(reinterpret_cast<char *>(&obj) + used, 0, sizeof(buffer_t) - used);
+    }
+
+    storage(storage const &other) : obj() { // zeroed for relocate(), as above
         other.descr->copy_constructor(&obj, &other.obj);
         descr = other.descr;
+        invoker = other.invoker;
     };
 
     storage(storage &&other) noexcept {
@@ -141,15 +305,16 @@ struct storage {
 
     R invoke(Args &&... args) const {
         void const *const_void = &obj;
-        return descr->invoke(const_cast<void *>(const_void), std::forward<Args>(args)...);
+        return invoker(const_cast<void *>(const_void), std::forward<Args>(args)...);
     }
 
     void swap(storage &other) noexcept {
-        std::aligned_storage<sizeof(void *), alignof(void *)>::type temp;
-        other.descr->move_constructor(&temp, &other.obj);
-        descr->move_constructor(&other.obj, &obj);
-        other.descr->move_constructor(&obj, &temp);
+        buffer_t temp;
+        relocate(other.descr, &temp, &other.obj);
+        relocate(descr, &other.obj, &obj);
+        relocate(other.descr, &obj, &temp);
         std::swap(descr, other.descr);
+        std::swap(invoker, other.invoker);
     }
 
     void *void_target() noexcept {
@@ -160,22 +325,59 @@ struct storage {
         return descr->const_target(&obj);
     }
 
-    std::aligned_storage<sizeof(void *), alignof(void *)>::type obj;
+    // Target if the callable is of the given type. The descriptor it usually has is compared first,
+    // which needs neither a load nor an indirect call; the type also finds it behind any other
+    // descriptor, e.g. in shared storage or a copy of the table made by another shared library.
+    void *void_target(descriptor<R, Args...> const *usual, type_id_t type) noexcept {
+        if (descr == usual) {
+            return usual->target(&obj);
+        }
+        return descr->type == type ? descr->target(&obj) : nullptr;
+    }
+
+    void const *void_const_target(descriptor<R, Args...> const *usual, type_id_t type) const noexcept {
+        if (descr == usual) {
+            return usual->const_target(&obj);
+        }
+        return descr->type == type ? descr->const_target(&obj) : nullptr;
+    }
+
+    buffer_t obj;
     descriptor<R, Args...> const *descr;
+    invoke_fn_t invoker;
 
 private :
+    // Trivially copyable objects and pointers to heap objects are moved without an indirect call.
+    static void relocate(descriptor<R, Args...> const *descriptor, void *dest, void *src) noexcept {
+        if (descriptor->relocatable) {
+            std::memcpy(dest, src, sizeof(buffer_t));
+        } else {
+            descriptor->move_constructor(dest, src);
+        }
+    }
+
     void move_initialize(storage &&other) {
-        other.descr->move_constructor(&obj, &other.obj);
+        relocate(other.descr, &obj, &other.obj);
         descr = other.descr;
-        other.descr = get_empty_descriptor<R, Args ...>();
+        invoker = other.invoker;
+        other.descr = descriptor<R, Args...>::empty();
+        other.invoker = other.descr->invoke;
     }
 };
 
-template<typename T>
+// Callables of at most InlineBytes bytes whose alignment divides Align and whose move
+// constructor does not throw are stored inline, all others are allocated on the heap.
+template<typename T, std::size_t InlineBytes = sizeof(void *), std::size_t Align = alignof(void *)>
 struct function;
 
-template<typename R, typename... Args>
-struct function<R(Args...)> {
+template<typename R, typename... Args, std::size_t InlineBytes, std::size_t Align>
+struct function<R(Args...), InlineBytes, Align> {
+    static_assert(InlineBytes >= sizeof(void *) && Align % alignof(void *) == 0,
+                  "the inline buffer must be able to hold a pointer");
+
+    template<typename T>
+    static constexpr bool is_small = is_small_v<T, InlineBytes, Align>;
+
     function() noexcept: stg(get_empty_descriptor<R, Args ...>()) {};
 
     function(function const &other) = default;
@@ -183,14 +385,35 @@ struct function<R(Args...)> {
     function(function &&other) noexcept = default;
 
     template<typename T>
-    function(T val) : stg(object_traits<T, is_small_v<T>>().template get_type_descriptor<R, Args ...>()) {
-        if constexpr (is_small_v<T>) {
+    function(T val) : function(std::allocator_arg, std::pmr::get_default_resource(), std::move(val)) {}
+
+    // A callable that is not stored inline is allocated from resource, and so are its copies.
+    template<typename T>
+    function(std::allocator_arg_t, std::pmr::memory_resource *resource, T val)
+            : stg(object_traits<T, is_small<T>>().template get_type_descriptor<R, Args ...>(),
+                  inline_size_v<T, InlineBytes, Align>) {
+        if constexpr (is_small<T>) {
             new(&stg.obj) T(std::move(val));
         } else {
-            reinterpret_cast<T *&>(stg.obj) = new T(std::move(val));
+            reinterpret_cast<heap_object<T> *&>(stg.obj) = heap_object<T>::create(resource, std::move(val));
         }
     }
 
+    // Stores the callable on the heap once, so that copies of the function only increment a
+    // reference count. It is never modified: it must be invocable as const, and only the const
+    // target<T>() finds it.
+    template<typename T>
+    function(shared_storage_t, T val)
+            : function(std::allocator_arg, std::pmr::get_default_resource(), shared_storage, std::move(val)) {}
+
+    template<typename T>
+    function(std::allocator_arg_t, std::pmr::memory_resource *resource, shared_storage_t, T val)
+            : stg(shared_object_traits<T>::template get_type_descriptor<R, Args ...>(), sizeof(void *)) {
+        static_assert(std::is_invocable_r_v<R, T const &, Args...>, "a shared callable must be const-invocable");
+        reinterpret_cast<heap_object<shared_object<T>> *&>(stg.obj) =
+                heap_object<shared_object<T>>::create(resource, std::move(val));
+    }
+
     function &operator=(function const &rhs) {
         if (this != &rhs) {
             function(rhs).swap(*this);
@@ -211,6 +434,10 @@ struct function<R(Args...)> {
         stg.swap(other.stg);
     }
 
+    friend void swap(function &a, function &b) noexcept {
+        a.swap(b);
+    }
+
     R operator()(Args... args) const {
         return stg.invoke(std::forward<Args>(args) ...);
     }
@@ -219,24 +446,26 @@ struct function<R(Args...)> {
         return stg.descr != get_empty_descriptor<R, Args...>();
     }
 
+    // type_id of the stored callable, type_id<void>() if the function is empty.
+    type_id_t target_type() const noexcept {
+        return stg.descr->type;
+    }
+
     template<typename T>
     T *target() noexcept {
-        if (stg.descr == object_traits<T, is_small_v<T>>().template get_type_descriptor<R, Args ...>()) {
-            return static_cast<T *>(stg.void_target());
-        } else {
-            return nullptr;
-        }
+        auto usual = object_traits<T, is_small<T>>().template get_type_descriptor<R, Args ...>();
+        return static_cast<T *>(stg.void_target(usual, type_id<T>()));
     }
 
     template<typename T>
     T const *target() const noexcept {
-        if (stg.descr == object_traits<T, is_small_v<T>>().template get_type_descriptor<R, Args ...>()) {
-            return static_cast<T const *>(stg.void_const_target());
-        } else {
-            return nullptr;
-        }
+        auto usual = object_traits<T, is_small<T>>().template get_type_descriptor<R, Args ...>();
+        return static_cast<T const *>(stg.void_const_target(usual, type_id<T>()));
     }
 
 private :
-    storage<R, Args...> stg;
+    template<typename T>
+    friend struct function_ref;
+
+    storage<InlineBytes, Align, R, Args...> stg;
 };
@@ -0,0 +1,781 @@
+#include "bench_utils.h"
+#include "callable_pool.h"
+#include "function.h"
+#include "function_ref.h"
+#include "function_vector.h"
+#include "move_only_function.h"
+#include "overloaded_function.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+void *operator new(std::size_t size) {
+    bench::allocation_counter().fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// std::pmr::new_delete_resource() allocates with the aligned forms.
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    bench::allocation_counter().fetch_add(1, std::memory_order_relaxed);
+    auto align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+    void *p = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    void *p = std::aligned_alloc(align, (size + align) / align * align);
+#endif
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+namespace {
+    std::size_t repeats = 5;
+
+    // Lambda with a capture of Bytes bytes, like one that captures Bytes / 8 pointers.
+    template<std::size_t Bytes>
+    auto make_callable(std::size_t seed) {
+        struct {
+            std::size_t words[Bytes / sizeof(std::size_t)];
+        } capture{};
+        capture.words[0] = seed;
+        return [capture](std::size_t x) noexcept {
+            return x + capture.words[0];
+        };
+    }
+
+    template<typename Function, std::size_t Bytes>
+    void bench_capture(std::string const &function_name, std::size_t n) {
+        static_assert(sizeof(make_callable<Bytes>(0)) == Bytes);
+        std::string suffix = "/" + function_name + "/capture:" + std::to_string(Bytes);
+        std::vector<Function> functions;
+        functions.reserve(n);
+
+        bench::measure_and_report("construct + destroy" + suffix, n, repeats, [] {}, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                functions.emplace_back(make_callable<Bytes>(i));
+            }
+            functions.clear();
+        });
+
+        for (std::size_t i = 0; i < n; ++i) {
+            functions.emplace_back(make_callable<Bytes>(i));
+        }
+        bench::measure_and_report("invoke" + suffix, n, repeats, [] {}, [&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += functions[i](i);
+            }
+            bench::do_not_optimize(sum);
+        });
+    }
+
+    template<std::size_t InlineBytes>
+    void bench_inline_size(std::size_t n) {
+        using fn = function<std::size_t(std::size_t), InlineBytes>;
+        std::string name = "function/inline:" + std::to_string(InlineBytes);
+        bench_capture<fn, 8>(name, n);
+        bench_capture<fn, 16>(name, n);
+        bench_capture<fn, 32>(name, n);
+        bench_capture<fn, 64>(name, n);
+    }
+
+    void bench_inline_sizes(std::size_t n) {
+        bench_inline_size<8>(n);
+        bench_inline_size<16>(n);
+        bench_inline_size<32>(n);
+        bench_inline_size<64>(n);
+        using std_fn = std::function<std::size_t(std::size_t)>;
+        bench_capture<std_fn, 8>("std::function", n);
+        bench_capture<std_fn, 16>("std::function", n);
+        bench_capture<std_fn, 32>("std::function", n);
+        bench_capture<std_fn, 64>("std::function", n);
+    }
+
+    // A function that takes a callback only to call it before returning.
+    template<typename Callback>
+    BENCH_NOINLINE std::size_t accept(Callback f, std::size_t x) {
+        return f(x);
+    }
+
+    template<typename Callback, std::size_t Bytes>
+    void bench_pass_lambda(std::string const &callback_name, std::size_t n) {
+        bench::measure_and_report("pass/lambda/" + callback_name + "/capture:" + std::to_string(Bytes),
+                                  n, repeats, [] {}, [&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += accept<Callback>(make_callable<Bytes>(i), i);
+            }
+            bench::do_not_optimize(sum);
+        });
+    }
+
+    // The caller already holds a function and passes it down.
+    template<typename Callback, typename Stored, std::size_t Bytes>
+    void bench_pass_stored(std::string const &callback_name, std::size_t n) {
+        Stored stored = make_callable<Bytes>(1);
+        bench::measure_and_report("pass/stored/" + callback_name + "/capture:" + std::to_string(Bytes),
+                                  n, repeats, [] {}, [&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += accept<Callback>(stored, i);
+            }
+            bench::do_not_optimize(sum);
+        });
+    }
+
+    template<std::size_t Bytes>
+    void bench_pass(std::size_t n) {
+        using fn = function<std::size_t(std::size_t)>;
+        using std_fn = std::function<std::size_t(std::size_t)>;
+        using ref = function_ref<std::size_t(std::size_t)>;
+        bench_pass_lambda<ref, Bytes>("function_ref", n);
+        bench_pass_lambda<fn, Bytes>("function", n);
+        bench_pass_lambda<std_fn, Bytes>("std::function", n);
+        bench_pass_stored<ref, fn, Bytes>("function_ref", n);
+        bench_pass_stored<fn, fn, Bytes>("function", n);
+        bench_pass_stored<std_fn, std_fn, Bytes>("std::function", n);
+    }
+
+    void bench_parameter_passing(std::size_t n) {
+        bench_pass<8>(n);
+        bench_pass<32>(n);
+        bench_pass<64>(n);
+    }
+
+    // A move-only resource handle that does not allocate, e.g. a file descriptor.
+    struct ticket {
+        explicit ticket(std::size_t id) noexcept: id(id) {}
+
+        ticket(ticket &&other) noexcept: id(other.id) {
+            other.id = 0;
+        }
+
+        ticket(ticket const &) = delete;
+
+        std::size_t id;
+    };
+
+    // Tasks capture a ticket and two words; they are queued, moved to a worker's queue and run.
+    template<typename Task, typename MakeTask>
+    void bench_task_queue(std::string const &name, std::size_t n, MakeTask make_task) {
+        std::vector<Task> queue;
+        std::vector<Task> worker;
+        queue.reserve(n);
+        worker.reserve(n);
+        bench::measure_and_report("task_queue/" + name, n, repeats, [&] {
+            queue.clear();
+            worker.clear();
+        }, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                queue.emplace_back(make_task(i));
+            }
+            for (Task &task : queue) {
+                worker.push_back(std::move(task));
+            }
+            std::size_t sum = 0;
+            for (Task &task : worker) {
+                sum += task();
+            }
+            bench::do_not_optimize(sum);
+        });
+    }
+
+    void bench_move_only(std::size_t n) {
+        bench_task_queue<move_only_function<std::size_t()>>("move_only_function", n, [](std::size_t i) {
+            return [t = ticket(i), a = i, b = i] { return t.id + a + b; };
+        });
+        // copyable wrappers need the handle in a shared_ptr
+        auto make_shared_task = [](std::size_t i) {
+            return [t = std::make_shared<ticket>(i), a = i, b = i] { return t->id + a + b; };
+        };
+        bench_task_queue<function<std::size_t()>>("function/shared_ptr", n, make_shared_task);
+        bench_task_queue<function<std::size_t(), 4 * sizeof(void *)>>("function/inline:32/shared_ptr", n,
+                                                                      make_shared_task);
+        bench_task_queue<std::function<std::size_t()>>("std::function/shared_ptr", n, make_shared_task);
+    }
+
+    template<typename Callable>
+    void bench_call(std::string const &name, Callable const &f, std::size_t n) {
+        bench::measure_and_report("call/" + name, n, repeats, [] {}, [&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += f(i);
+            }
+            bench::do_not_optimize(sum);
+        });
+    }
+
+    BENCH_NOINLINE std::size_t add_one(std::size_t x) {
+        return x + 1;
+    }
+
+    struct callback {
+        virtual ~callback() = default;
+
+        virtual std::size_t operator()(std::size_t x) const = 0;
+    };
+
+    struct add_one_callback : callback {
+        BENCH_NOINLINE std::size_t operator()(std::size_t x) const override {
+            return x + 1;
+        }
+    };
+
+    // Cost of one call through each wrapper; the callables do almost nothing.
+    void bench_call_overhead(std::size_t n) {
+        auto lambda = make_callable<8>(1);
+        bench_call("direct", lambda, n);
+        std::size_t (*volatile pointer)(std::size_t) = add_one;
+        bench_call("function_pointer", pointer, n);
+        add_one_callback const implementation;
+        // hides the dynamic type, so that the call is not devirtualized
+        callback const *volatile virtual_call = &implementation;
+        bench_call("virtual", *virtual_call, n);
+        bench_call("function_ref", function_ref<std::size_t(std::size_t)>(lambda), n);
+        bench_call("function/capture:8", function<std::size_t(std::size_t)>(lambda), n);
+        bench_call("function/capture:64", function<std::size_t(std::size_t)>(make_callable<64>(1)), n);
+        bench_call("move_only_function/capture:8", move_only_function<std::size_t(std::size_t)>(lambda), n);
+        bench_call("std::function/capture:8", std::function<std::size_t(std::size_t)>(lambda), n);
+        bench_call("std::function/capture:64", std::function<std::size_t(std::size_t)>(make_callable<64>(1)), n);
+    }
+
+    // Containers relocate their functions when they grow and when elements are rotated.
+    template<typename Function, typename MakeCallable>
+    void bench_relocation(std::string const &name, std::size_t n, MakeCallable make_callable) {
+        std::vector<Function> functions;
+        bench::measure_and_report("vector_growth/" + name, n, repeats, [&] {
+            functions = std::vector<Function>();
+        }, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                functions.emplace_back(make_callable(i));
+            }
+        });
+        bench::measure_and_report("rotate/" + name, n, repeats, [] {}, [&] {
+            std::rotate(functions.begin(), functions.begin() + n / 3, functions.end());
+        });
+    }
+
+    void bench_relocations(std::size_t n) {
+        using fn = function<std::size_t(std::size_t)>;
+        using fn_inline_32 = function<std::size_t(std::size_t), 4 * sizeof(void *)>;
+        using std_fn = std::function<std::size_t(std::size_t)>;
+        auto trivial_8 = [](std::size_t i) { return make_callable<8>(i); };
+        auto trivial_32 = [](std::size_t i) { return make_callable<32>(i); };
+        auto shared = [resource = std::make_shared<std::size_t>(1)](std::size_t) {
+            return [resource](std::size_t x) { return x + *resource; };
+        };
+        bench_relocation<fn>("function/capture:8", n, trivial_8);
+        bench_relocation<fn>("function/capture:32", n, trivial_32);
+        bench_relocation<fn_inline_32>("function/inline:32/capture:32", n, trivial_32);
+        bench_relocation<fn_inline_32>("function/inline:32/shared_ptr", n, shared);
+        bench_relocation<std_fn>("std::function/capture:8", n, trivial_8);
+        bench_relocation<std_fn>("std::function/capture:32", n, trivial_32);
+    }
+
+    // Tasks are submitted and destroyed in batches, so freed blocks are reused by the next batch.
+    template<std::size_t Bytes>
+    void bench_resource(std::string const &resource_name, std::pmr::memory_resource *resource, std::size_t n) {
+        using fn = function<std::size_t(std::size_t)>;
+        std::vector<fn> functions;
+        functions.reserve(n);
+        bench::measure_and_report("submit + destroy/" + resource_name + "/capture:" + std::to_string(Bytes),
+                                  n, repeats, [] {}, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                functions.emplace_back(std::allocator_arg, resource, make_callable<Bytes>(i));
+            }
+            functions.clear();
+        });
+    }
+
+    template<std::size_t Bytes>
+    void bench_resources(std::size_t n) {
+        bench_resource<Bytes>("new_delete", std::pmr::new_delete_resource(), n);
+        callable_pool pool;
+        bench_resource<Bytes>("callable_pool", &pool, n);
+        std::pmr::unsynchronized_pool_resource std_pool;
+        bench_resource<Bytes>("std::pmr::unsynchronized_pool_resource", &std_pool, n);
+    }
+
+    void bench_memory_resources(std::size_t n) {
+        bench_resources<32>(n);
+        bench_resources<128>(n);
+    }
+
+    // The same handler is copied into many subscriber slots.
+    template<typename Function>
+    void bench_copies(std::string const &name, Function const &handler, std::size_t n) {
+        std::vector<Function> slots;
+        slots.reserve(n);
+        bench::measure_and_report("copy/" + name, n, repeats, [&] {
+            slots.clear();
+        }, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                slots.push_back(handler);
+            }
+        });
+    }
+
+    template<std::size_t Bytes>
+    void bench_shared(std::size_t n) {
+        using fn = function<std::size_t(std::size_t)>;
+        std::string capture = "/capture:" + std::to_string(Bytes);
+        bench_copies("function" + capture, fn(make_callable<Bytes>(1)), n);
+        bench_copies("function/shared_storage" + capture, fn(shared_storage, make_callable<Bytes>(1)), n);
+        bench_copies("std::function" + capture,
+                     std::function<std::size_t(std::size_t)>(make_callable<Bytes>(1)), n);
+    }
+
+    void bench_shared_storage(std::size_t n) {
+        bench_shared<64>(n);
+        bench_shared<512>(n);
+    }
+
+    struct event {
+        std::size_t *sum;
+        std::size_t value;
+    };
+
+    template<std::size_t Bytes>
+    auto make_handler(std::size_t seed) {
+        struct {
+            std::size_t words[Bytes / sizeof(std::size_t)];
+        } capture{};
+        capture.words[0] = seed;
+        return [capture](event const &e) noexcept {
+            *e.sum += e.value ^ capture.words[0];
+        };
+    }
+
+    // Handlers of 8, 24, 56 and 120 bytes in turn.
+    template<typename Container>
+    auto add_handler(Container &handlers, std::size_t i) {
+        switch (i % 4) {
+            case 0:
+                return handlers.push_back(make_handler<8>(i));
+            case 1:
+                return handlers.push_back(make_handler<24>(i));
+            case 2:
+                return handlers.push_back(make_handler<56>(i));
+            default:
+                return handlers.push_back(make_handler<120>(i));
+        }
+    }
+
+    template<typename Function>
+    void bench_handler_vector(std::string const &name, std::size_t n) {
+        std::vector<Function> handlers;
+        for (std::size_t i = 0; i < n; ++i) {
+            add_handler(handlers, i);
+        }
+        // subscriptions come and go, so neighbouring handlers live far apart on the heap
+        std::shuffle(handlers.begin(), handlers.end(), std::mt19937_64(42));
+        std::size_t sum = 0;
+        bench::measure_and_report("invoke_all/" + name, n, repeats, [] {}, [&] {
+            event e{&sum, 1};
+            for (Function const &handler : handlers) {
+                handler(e);
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::measure_and_report("erase_half/" + name, n / 2, repeats, [&] {
+            handlers.clear();
+            for (std::size_t i = 0; i < n; ++i) {
+                add_handler(handlers, i);
+            }
+        }, [&] {
+            handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [&](Function const &f) {
+                return (&f - handlers.data()) % 2 == 1;
+            }), handlers.end());
+        });
+    }
+
+    void bench_function_vector(std::size_t n) {
+        using fn_vector = function_vector<void(event const &)>;
+        fn_vector handlers;
+        std::vector<fn_vector::id_t> ids;
+        for (std::size_t i = 0; i < n; ++i) {
+            add_handler(handlers, i);
+        }
+        std::size_t sum = 0;
+        bench::measure_and_report("invoke_all/function_vector", n, repeats, [] {}, [&] {
+            handlers.invoke_all(event{&sum, 1});
+        });
+        bench::do_not_optimize(sum);
+        bench::measure_and_report("erase_half + compact/function_vector", n / 2, repeats, [&] {
+            handlers.clear();
+            ids.clear();
+            for (std::size_t i = 0; i < n; ++i) {
+                ids.push_back(add_handler(handlers, i));
+            }
+        }, [&] {
+            for (std::size_t i = 1; i < n; i += 2) {
+                handlers.erase(ids[i]);
+            }
+            handlers.compact();
+        });
+
+        bench_handler_vector<function<void(event const &)>>("vector<function>", n);
+        bench_handler_vector<std::function<void(event const &)>>("vector<std::function>", n);
+    }
+
+    // function-like wrapper over a classic interface: a heap object with virtual call and clone.
+    struct virtual_callback {
+        struct interface {
+            virtual ~interface() = default;
+
+            virtual std::size_t operator()(std::size_t x) const = 0;
+
+            virtual std::unique_ptr<interface> clone() const = 0;
+        };
+
+        template<typename T>
+        struct implementation : interface {
+            explicit implementation(T callable) : callable(std::move(callable)) {}
+
+            std::size_t operator()(std::size_t x) const override {
+                return callable(x);
+            }
+
+            std::unique_ptr<interface> clone() const override {
+                return std::make_unique<implementation>(callable);
+            }
+
+            T callable;
+        };
+
+        virtual_callback() = default;
+
+        template<typename T>
+        explicit virtual_callback(T callable) : object(std::make_unique<implementation<T>>(std::move(callable))) {}
+
+        virtual_callback(virtual_callback const &other) : object(other.object ? other.object->clone() : nullptr) {}
+
+        virtual_callback(virtual_callback &&) noexcept = default;
+
+        virtual_callback &operator=(virtual_callback const &rhs) {
+            virtual_callback(rhs).object.swap(object);
+            return *this;
+        }
+
+        virtual_callback &operator=(virtual_callback &&) noexcept = default;
+
+        std::size_t operator()(std::size_t x) const {
+            return (*object)(x);
+        }
+
+        explicit operator bool() const noexcept {
+            return object != nullptr;
+        }
+
+        template<typename T>
+        T *target() noexcept {
+            auto *impl = dynamic_cast<implementation<T> *>(object.get());
+            return impl == nullptr ? nullptr : &impl->callable;
+        }
+
+        std::unique_ptr<interface> object;
+    };
+
+    // How each contender is built, checked for emptiness and asked for its target.
+    template<std::size_t Bytes>
+    struct direct_kind {
+        using callable_t = decltype(make_callable<Bytes>(0));
+        using type = callable_t;
+
+        static type make(std::size_t i) {
+            return make_callable<Bytes>(i);
+        }
+
+        static bool is_empty(type const &) {
+            return false;
+        }
+
+        static callable_t *target(type &f) {
+            return &f;
+        }
+    };
+
+    template<typename Function, std::size_t Bytes>
+    struct wrapper_kind {
+        using callable_t = decltype(make_callable<Bytes>(0));
+        using type = Function;
+
+        static type make(std::size_t i) {
+            return type(make_callable<Bytes>(i));
+        }
+
+        static bool is_empty(type const &f) {
+            return !f;
+        }
+
+        static callable_t *target(type &f) {
+            return f.template target<callable_t>();
+        }
+    };
+
+    template<typename Kind>
+    void bench_operations(std::string const &kind_name, std::size_t n) {
+        using type = typename Kind::type;
+        std::string suffix = "/" + kind_name;
+        std::vector<type> functions;
+        std::vector<type> copies;
+        std::vector<type> moved;
+        functions.reserve(n);
+        copies.reserve(n);
+        moved.reserve(n);
+
+        bench::measure_and_report("construct + destroy" + suffix, n, repeats, [] {}, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                functions.push_back(Kind::make(i));
+            }
+            functions.clear();
+        });
+        for (std::size_t i = 0; i < n; ++i) {
+            functions.push_back(Kind::make(i));
+        }
+        bench::measure_and_report("copy" + suffix, n, repeats, [&] {
+            copies.clear();
+        }, [&] {
+            for (type const &f : functions) {
+                copies.push_back(f);
+            }
+        });
+        bench::measure_and_report("move" + suffix, n, repeats, [&] {
+            moved.clear();
+            copies.clear();
+            for (type const &f : functions) {
+                copies.push_back(f);
+            }
+        }, [&] {
+            for (type &f : copies) {
+                moved.push_back(std::move(f));
+            }
+        });
+        // closures are not assignable, so callables are swapped only through wrappers
+        if constexpr (std::is_swappable_v<type>) {
+            bench::measure_and_report("swap" + suffix, n / 2, repeats, [] {}, [&] {
+                using std::swap;
+                for (std::size_t i = 0; i < n / 2; ++i) {
+                    swap(functions[i], functions[n - 1 - i]);
+                }
+            });
+        }
+        bench::measure_and_report("invoke" + suffix, n, repeats, [] {}, [&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += functions[i](i);
+            }
+            bench::do_not_optimize(sum);
+        });
+        bench::measure_and_report("empty_check" + suffix, n, repeats, [] {}, [&] {
+            std::size_t empty = 0;
+            for (type const &f : functions) {
+                empty += Kind::is_empty(f);
+            }
+            bench::do_not_optimize(empty);
+        });
+        bench::measure_and_report("target" + suffix, n, repeats, [] {}, [&] {
+            std::size_t found = 0;
+            for (type &f : functions) {
+                found += Kind::target(f) != nullptr;
+            }
+            bench::do_not_optimize(found);
+        });
+    }
+
+    template<std::size_t Bytes>
+    void bench_operations_for_size(std::size_t n) {
+        using result_t = std::size_t(std::size_t);
+        std::string capture = "/capture:" + std::to_string(Bytes);
+        bench_operations<direct_kind<Bytes>>("direct" + capture, n);
+        bench_operations<wrapper_kind<function<result_t>, Bytes>>("function" + capture, n);
+        bench_operations<wrapper_kind<function<result_t, 4 * sizeof(void *)>, Bytes>>("function/inline:32" + capture, n);
+        bench_operations<wrapper_kind<std::function<result_t>, Bytes>>("std::function" + capture, n);
+        bench_operations<wrapper_kind<virtual_callback, Bytes>>("virtual" + capture, n);
+    }
+
+    void bench_all_operations(std::size_t n) {
+        bench_operations_for_size<8>(n);
+        bench_operations_for_size<16>(n);
+        bench_operations_for_size<32>(n);
+        bench_operations_for_size<64>(n);
+        bench_operations_for_size<128>(n);
+    }
+
+    struct key_press {
+        std::size_t value;
+    };
+
+    struct click {
+        std::size_t value;
+    };
+
+    // Handler of both events with a capture of Bytes bytes.
+    template<std::size_t Bytes>
+    auto make_event_handler(std::size_t seed) {
+        struct {
+            std::size_t words[Bytes / sizeof(std::size_t)];
+        } capture{};
+        capture.words[0] = seed;
+        return [capture](auto e) noexcept {
+            return e.value ^ capture.words[0];
+        };
+    }
+
+    using key_and_click_handler = overloaded_function<std::size_t(key_press), std::size_t(click)>;
+
+    // What a handler of two events takes without overloaded_function.
+    struct handler_pair {
+        template<typename F>
+        explicit handler_pair(F const &f) : on_key(f), on_click(f) {}
+
+        std::size_t operator()(key_press e) const {
+            return on_key(e);
+        }
+
+        std::size_t operator()(click e) const {
+            return on_click(e);
+        }
+
+        function<std::size_t(key_press)> on_key;
+        function<std::size_t(click)> on_click;
+    };
+
+    template<typename Handler, std::size_t Bytes>
+    void bench_event_handler(std::string const &handler_name, std::size_t n) {
+        std::string suffix = "/" + handler_name + "/capture:" + std::to_string(Bytes);
+        std::vector<Handler> handlers;
+        std::vector<Handler> copies;
+        handlers.reserve(n);
+        copies.reserve(n);
+
+        bench::measure_and_report("construct + destroy" + suffix, n, repeats, [] {}, [&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                handlers.emplace_back(make_event_handler<Bytes>(i));
+            }
+            handlers.clear();
+        });
+        for (std::size_t i = 0; i < n; ++i) {
+            handlers.emplace_back(make_event_handler<Bytes>(i));
+        }
+        bench::measure_and_report("copy" + suffix, n, repeats, [&] {
+            copies.clear();
+        }, [&] {
+            for (Handler const &h : handlers) {
+                copies.push_back(h);
+            }
+        });
+        bench::measure_and_report("invoke both" + suffix, n, repeats, [] {}, [&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += handlers[i](key_press{i}) + handlers[i](click{i});
+            }
+            bench::do_not_optimize(sum);
+        });
+    }
+
+    void bench_overloaded(std::size_t n) {
+        bench_event_handler<key_and_click_handler, 8>("overloaded_function", n);
+        bench_event_handler<handler_pair, 8>("two functions", n);
+        bench_event_handler<key_and_click_handler, 32>("overloaded_function", n);
+        bench_event_handler<handler_pair, 32>("two functions", n);
+    }
+
+    bool starts_with(char const *s, char const *prefix) {
+        return std::strncmp(s, prefix, std::strlen(prefix)) == 0;
+    }
+
+    void usage(char const *program) {
+        std::fprintf(stderr, "usage: %s [--size=N] [--repeats=N] [--benchmarks=NAME,...] [--json[=FILE]]\n"
+                             "benchmarks: operations, call, inline_size, function_ref, move_only, relocation,\n"
+                             "            memory_resource, shared_storage, function_vector, overloaded (default: all)\n"
+                             "Results are the best of the repeats; --json output can be compared between builds.\n",
+                     program);
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t n = 100000;
+    std::string selected;
+    char const *json_file = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        char const *arg = argv[i];
+        if (starts_with(arg, "--size=")) {
+            n = std::strtoull(arg + 7, nullptr, 10);
+        } else if (starts_with(arg, "--repeats=")) {
+            repeats = std::max<std::size_t>(1, std::strtoull(arg + 10, nullptr, 10));
+        } else if (starts_with(arg, "--benchmarks=")) {
+            selected = "," + std::string(arg + 13) + ",";
+        } else if (std::strcmp(arg, "--json") == 0) {
+            bench::current_reporter().json = true;
+        } else if (starts_with(arg, "--json=")) {
+            json_file = arg + 7;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    bench::current_reporter().parameters.emplace_back("size", n);
+    bench::current_reporter().parameters.emplace_back("repeats", repeats);
+    auto run = [&selected](char const *name) {
+        return selected.empty() || selected.find("," + std::string(name) + ",") != std::string::npos;
+    };
+    if (run("operations")) bench_all_operations(n);
+    if (run("call")) bench_call_overhead(n);
+    if (run("inline_size")) bench_inline_sizes(n);
+    if (run("function_ref")) bench_parameter_passing(n);
+    if (run("move_only")) bench_move_only(n);
+    if (run("relocation")) bench_relocations(n);
+    if (run("memory_resource")) bench_memory_resources(n);
+    if (run("shared_storage")) bench_shared_storage(n);
+    if (run("function_vector")) bench_function_vector(n);
+    if (run("overloaded")) bench_overloaded(n);
+
+    bench::reporter const &reporter = bench::current_reporter();
+    if (reporter.json) {
+        reporter.write_json(stdout);
+    }
+    if (json_file != nullptr) {
+        std::FILE *out = std::fopen(json_file, "w");
+        if (out == nullptr) {
+            std::perror(json_file);
+            return 1;
+        }
+        reporter.write_json(out);
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "function.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+template<typename T, typename Signature>
+struct is_function_of : std::false_type {};
+
+template<typename Signature, std::size_t InlineBytes, std::size_t Align>
+struct is_function_of<function<Signature, InlineBytes, Align>, Signature> : std::true_type {};
+
+// Non-owning reference to a callable: a pointer to it and a call thunk, two words that are
+// cheap to pass by value. It never allocates and does not extend the lifetime of the callable,
+// so it is meant for parameters of functions that call it before returning.
+template<typename T>
+struct function_ref;
+
+template<typename R, typename... Args>
+struct function_ref<R(Args...)> {
+    template<typename F, typename = std::enable_if_t<
+            !std::is_same_v<std::decay_t<F>, function_ref>
+            && !is_function_of<std::decay_t<F>, R(Args...)>::value
+            && std::is_invocable_r_v<R, F &, Args...>>>
+    function_ref(F &&f) noexcept {
+        using callable_t = std::remove_reference_t<F>;
+        using pointer_t = std::decay_t<F>;
+        if constexpr (std::is_pointer_v<pointer_t> && std::is_function_v<std::remove_pointer_t<pointer_t>>) {
+            // functions are referred to by their address, so that &foo may be a temporary
+            obj = reinterpret_cast<void *>(static_cast<pointer_t>(f));
+            call = [](void *obj, Args &&... args) -> R {
+                return invoke_as(reinterpret_cast<pointer_t>(obj), std::forward<Args>(args)...);
+            };
+        } else {
+            obj = const_cast<void *>(static_cast<void const *>(std::addressof(f)));
+            call = [](void *obj, Args &&... args) -> R {
+                return invoke_as(*static_cast<callable_t *>(obj), std::forward<Args>(args)...);
+            };
+        }
+    }
+
+    // Refers to the callable stored in f and calls it with a single indirect call, so f must
+    // not be assigned to while referred to. Calling a reference to an empty f throws bad_function_call.
+    template<std::size_t InlineBytes, std::size_t Align>
+    function_ref(function<R(Args...), InlineBytes, Align> const &f) noexcept {
+        void const *target = &f.stg.obj;
+        obj = const_cast<void *>(target);
+        call = f.stg.invoker;
+    }
+
+    function_ref(function_ref const &) noexcept = default;
+
+    function_ref &operator=(function_ref const &) noexcept = default;
+
+    R operator()(Args... args) const {
+        return call(obj, std::forward<Args>(args)...);
+    }
+
+private:
+    template<typename F>
+    static R invoke_as(F &&f, Args &&... args) {
+        if constexpr (std::is_void_v<R>) {
+            f(std::forward<Args>(args)...);
+        } else {
+            return f(std::forward<Args>(args)...);
+        }
+    }
+
+    void *obj;
+    R (*call)(void *, Args &&...);
+};
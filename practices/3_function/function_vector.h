@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Size, alignment, destructor and relocation of a callable stored in a function_vector.
+struct packed_object_ops {
+    using destroy_fn_t = void (*)(void *);
+    using relocate_fn_t = void (*)(void *dest, void *src);
+
+    destroy_fn_t destroy;
+    relocate_fn_t relocate;
+    std::size_t size;
+    std::size_t align;
+};
+
+template<typename T>
+packed_object_ops const *get_packed_object_ops() {
+    static constexpr packed_object_ops table{
+            [](void *obj) { // destroy
+                static_cast<T *>(obj)->~T();
+            },
+            [](void *dest, void *src) { // relocate, destroys src
+                new(dest) T(std::move(*static_cast<T *>(src)));
+                static_cast<T *>(src)->~T();
+            },
+            sizeof(T),
+            alignof(T)
+    };
+    return &table;
+}
+
+template<typename T>
+struct function_vector;
+
+// Sequence of callables of any types packed back to back in one buffer, each behind a header
+// with its invoke thunk, so that invoke_all() reads memory linearly. push_back() returns an id
+// that stays valid until the callable is erased; ids of erased callables are reused.
+// erase() only destroys the callable and leaves a hole that invoke_all() skips; holes are
+// dropped by compact() and whenever the buffer grows. Callables must be nothrow move
+// constructible and aligned to at most alignof(std::max_align_t), and must not modify
+// the vector while being invoked.
+template<typename R, typename... Args>
+struct function_vector<R(Args...)> {
+    using id_t = std::uint32_t;
+
+    function_vector() noexcept = default;
+
+    function_vector(function_vector const &) = delete;
+
+    function_vector(function_vector &&other) noexcept {
+        swap(other);
+    }
+
+    function_vector &operator=(function_vector const &) = delete;
+
+    function_vector &operator=(function_vector &&rhs) noexcept {
+        if (this != &rhs) {
+            function_vector(std::move(rhs)).swap(*this);
+        }
+        return *this;
+    }
+
+    ~function_vector() {
+        clear();
+        ::operator delete(data);
+    }
+
+    void swap(function_vector &other) noexcept {
+        std::swap(data, other.data);
+        std::swap(used, other.used);
+        std::swap(capacity, other.capacity);
+        std::swap(count, other.count);
+        offsets.swap(other.offsets);
+        free_ids.swap(other.free_ids);
+    }
+
+    template<typename F>
+    id_t push_back(F f) {
+        static_assert(std::is_nothrow_move_constructible_v<F>, "callables are relocated with their move constructor");
+        static_assert(alignof(F) <= alignof(std::max_align_t), "over-aligned callables are not supported");
+        static_assert(std::is_invocable_r_v<R, F &, Args const &...>, "callable has a wrong signature");
+
+        packed_object_ops const *ops = get_packed_object_ops<F>();
+        if (entry_size(used, ops) > capacity - used) {
+            std::size_t needed = live_bytes() + entry_size(0, ops) + alignof(std::max_align_t);
+            rebuild(std::max(2 * capacity, needed));
+        }
+        id_t id = allocate_id();
+        header *h = place(used, ops, id, [](void *end_of_header, Args const &... args) -> R {
+            return (*static_cast<F *>(align_object(end_of_header, alignof(F))))(args...);
+        });
+        new(object(h)) F(std::move(f));
+        offsets[id] = used;
+        used += h->size;
+        ++count;
+        return id;
+    }
+
+    // Calls every callable in insertion order and discards the results.
+    void invoke_all(Args const &... args) const {
+        std::byte *p = data;
+        std::byte *end = data + used;
+        while (p != end) {
+            header *h = reinterpret_cast<header *>(p);
+            if (h->invoke != nullptr) {
+                h->invoke(h + 1, args...);
+            }
+            p += h->size;
+        }
+    }
+
+    R invoke(id_t id, Args const &... args) const {
+        header *h = header_of(id);
+        return h->invoke(h + 1, args...);
+    }
+
+    void erase(id_t id) {
+        free_ids.push_back(id);
+        header *h = header_of(id);
+        h->ops->destroy(object(h));
+        h->invoke = nullptr;
+        offsets[id] = erased;
+        --count;
+    }
+
+    // Moves the callables together, dropping the holes left by erase(), and shrinks the buffer.
+    void compact() {
+        rebuild(live_bytes());
+    }
+
+    void clear() noexcept {
+        for_each_live([](header *h) {
+            h->ops->destroy(object(h));
+        });
+        used = 0;
+        count = 0;
+        offsets.clear();
+        free_ids.clear();
+    }
+
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    // Bytes of the buffer taken by callables, their headers and holes.
+    std::size_t bytes_used() const noexcept {
+        return used;
+    }
+
+private:
+    using invoke_fn_t = R (*)(void *, Args const &...);
+
+    static constexpr std::size_t erased = std::size_t(-1);
+
+    struct header {
+        invoke_fn_t invoke; // nullptr once erased; takes the end of the header
+        packed_object_ops const *ops;
+        std::uint32_t size; // to the next header
+        id_t id;
+    };
+
+    static std::size_t align_up(std::size_t n, std::size_t align) noexcept {
+        return (n + align - 1) / align * align;
+    }
+
+    // Headers are followed by padding up to the alignment of the callable, which its thunk knows statically.
+    static void *align_object(void *end_of_header, std::size_t align) noexcept {
+        auto address = reinterpret_cast<std::uintptr_t>(end_of_header);
+        return reinterpret_cast<void *>(align_up(address, align));
+    }
+
+    static void *object(header *h) noexcept {
+        return align_object(h + 1, h->ops->align);
+    }
+
+    // The buffer is aligned to alignof(std::max_align_t), so the layout depends only on the offset.
+    static std::size_t entry_size(std::size_t offset, packed_object_ops const *ops) noexcept {
+        std::size_t object_offset = align_up(offset + sizeof(header), ops->align);
+        return align_up(object_offset + ops->size, alignof(header)) - offset;
+    }
+
+    header *header_of(id_t id) const noexcept {
+        return reinterpret_cast<header *>(data + offsets[id]);
+    }
+
+    header *place(std::size_t offset, packed_object_ops const *ops, id_t id, invoke_fn_t invoke) noexcept {
+        auto size = static_cast<std::uint32_t>(entry_size(offset, ops));
+        return new(data + offset) header{invoke, ops, size, id};
+    }
+
+    id_t allocate_id() {
+        if (free_ids.empty()) {
+            offsets.push_back(erased);
+            return static_cast<id_t>(offsets.size() - 1);
+        }
+        id_t id = free_ids.back();
+        free_ids.pop_back();
+        return id;
+    }
+
+    template<typename F>
+    void for_each_live(F f) const {
+        for (std::byte *p = data; p != data + used; p += reinterpret_cast<header *>(p)->size) {
+            header *h = reinterpret_cast<header *>(p);
+            if (h->invoke != nullptr) {
+                f(h);
+            }
+        }
+    }
+
+    // Size of the live callables laid out back to back from the start of a buffer.
+    std::size_t live_bytes() const noexcept {
+        std::size_t bytes = 0;
+        for_each_live([&bytes](header *h) {
+            bytes += entry_size(bytes, h->ops);
+        });
+        return bytes;
+    }
+
+    void rebuild(std::size_t new_capacity) {
+        std::byte *old_data = data;
+        std::size_t old_used = used;
+        data = new_capacity == 0 ? nullptr : static_cast<std::byte *>(::operator new(new_capacity));
+        capacity = new_capacity;
+        used = 0;
+        for (std::byte *p = old_data; p != old_data + old_used; p += reinterpret_cast<header *>(p)->size) {
+            header *old_header = reinterpret_cast<header *>(p);
+            if (old_header->invoke == nullptr)
+                continue;
+            header *h = place(used, old_header->ops, old_header->id, old_header->invoke);
+            h->ops->relocate(object(h), object(old_header));
+            offsets[h->id] = used;
+            used += h->size;
+        }
+        ::operator delete(old_data);
+    }
+
+    std::byte *data = nullptr;
+    std::size_t used = 0;
+    std::size_t capacity = 0;
+    std::size_t count = 0;
+    std::vector<std::size_t> offsets; // of the header of each id, or erased
+    std::vector<id_t> free_ids;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "function.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Like function, but cannot be copied and accepts callables that cannot be copied either,
+// e.g. lambdas capturing a unique_ptr. The inline buffer defaults to three words, enough
+// for a task that captures a few pointers, so that moving it between queues does not allocate.
+template<typename T, std::size_t InlineBytes = 3 * sizeof(void *), std::size_t Align = alignof(void *)>
+struct move_only_function;
+
+template<typename R, typename... Args, std::size_t InlineBytes, std::size_t Align>
+struct move_only_function<R(Args...), InlineBytes, Align> {
+    static_assert(InlineBytes >= sizeof(void *) && Align % alignof(void *) == 0,
+                  "the inline buffer must be able to hold a pointer");
+
+    template<typename T>
+    static constexpr bool is_small = is_small_v<T, InlineBytes, Align>;
+
+    move_only_function() noexcept: stg(get_empty_descriptor<R, Args...>()) {};
+
+    move_only_function(move_only_function const &) = delete;
+
+    move_only_function(move_only_function &&other) noexcept = default;
+
+    template<typename T>
+    move_only_function(T val)
+            : move_only_function(std::allocator_arg, std::pmr::get_default_resource(), std::move(val)) {}
+
+    // A callable that is not stored inline is allocated from resource.
+    template<typename T>
+    move_only_function(std::allocator_arg_t, std::pmr::memory_resource *resource, T val)
+            : stg(object_traits<T, is_small<T>, false>().template get_type_descriptor<R, Args ...>(),
+                  inline_size_v<T, InlineBytes, Align>) {
+        if constexpr (is_small<T>) {
+            new(&stg.obj) T(std::move(val));
+        } else {
+            reinterpret_cast<heap_object<T> *&>(stg.obj) = heap_object<T>::create(resource, std::move(val));
+        }
+    }
+
+    move_only_function &operator=(move_only_function const &) = delete;
+
+    move_only_function &operator=(move_only_function &&rhs) noexcept {
+        if (this != &rhs) {
+            stg = std::move(rhs.stg);
+        }
+        return *this;
+    };
+
+    ~move_only_function() = default;
+
+    void swap(move_only_function &other) noexcept {
+        stg.swap(other.stg);
+    }
+
+    friend void swap(move_only_function &a, move_only_function &b) noexcept {
+        a.swap(b);
+    }
+
+    R operator()(Args... args) const {
+        return stg.invoke(std::forward<Args>(args) ...);
+    }
+
+    explicit operator bool() const noexcept {
+        return stg.descr != get_empty_descriptor<R, Args...>();
+    }
+
+    // type_id of the stored callable, type_id<void>() if the function is empty.
+    type_id_t target_type() const noexcept {
+        return stg.descr->type;
+    }
+
+    template<typename T>
+    T *target() noexcept {
+        auto usual = object_traits<T, is_small<T>, false>().template get_type_descriptor<R, Args ...>();
+        return static_cast<T *>(stg.void_target(usual, type_id<T>()));
+    }
+
+    template<typename T>
+    T const *target() const noexcept {
+        auto usual = object_traits<T, is_small<T>, false>().template get_type_descriptor<R, Args ...>();
+        return static_cast<T const *>(stg.void_const_target(usual, type_id<T>()));
+    }
+
+private :
+    storage<InlineBytes, Align, R, Args...> stg;
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "function.h"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Call thunk of one signature for a callable stored the way object_traits<T, isSmall> stores it.
+template<typename Signature>
+struct overloaded_thunk;
+
+template<typename R, typename... Args>
+struct overloaded_thunk<R(Args...)> {
+    using fn_t = R (*)(void *, Args &&...);
+
+    template<typename T, bool isSmall>
+    static R invoke(void *obj, Args &&... args) {
+        if constexpr (isSmall) {
+            return (*static_cast<T *>(obj))(std::forward<Args>(args)...);
+        } else {
+            return (*static_cast<heap_object<T> **>(obj))->value(std::forward<Args>(args)...);
+        }
+    }
+
+    static R empty(void *, Args &&...) {
+        throw bad_function_call();
+    }
+};
+
+template<typename... Signatures>
+using overloaded_thunks = std::tuple<typename overloaded_thunk<Signatures>::fn_t...>;
+
+template<typename T, bool isSmall, typename... Signatures>
+overloaded_thunks<Signatures...> const *get_overloaded_thunks() {
+    static constexpr overloaded_thunks<Signatures...> table{
+            &overloaded_thunk<Signatures>::template invoke<T, isSmall>...
+    };
+    return &table;
+}
+
+template<typename... Signatures>
+overloaded_thunks<Signatures...> const *get_empty_overloaded_thunks() {
+    static constexpr overloaded_thunks<Signatures...> table{&overloaded_thunk<Signatures>::empty...};
+    return &table;
+}
+
+// operator() of the I-th signature of Derived, which is an overloaded_function.
+template<typename Derived, std::size_t I, typename Signature>
+struct overloaded_call;
+
+template<typename Derived, std::size_t I, typename R, typename... Args>
+struct overloaded_call<Derived, I, R(Args...)> {
+    R operator()(Args... args) const {
+        auto const &self = static_cast<Derived const &>(*this);
+        if constexpr (I == 0) {
+            return self.stg.invoke(std::forward<Args>(args)...);
+        } else {
+            void const *obj = &self.stg.obj;
+            return std::get<I>(*self.thunks)(const_cast<void *>(obj), std::forward<Args>(args)...);
+        }
+    }
+};
+
+template<typename Derived, typename Indices, typename... Signatures>
+struct overloaded_calls;
+
+template<typename Derived, std::size_t... I, typename... Signatures>
+struct overloaded_calls<Derived, std::index_sequence<I...>, Signatures...>
+        : overloaded_call<Derived, I, Signatures> ... {
+    using overloaded_call<Derived, I, Signatures>::operator()...;
+};
+
+// Wrapper of one callable invocable with each of Signatures, e.g. a handler of several event
+// types; a call picks the signature by overload resolution on the arguments. The callable is
+// stored once, like in function with InlineBytes and Align, and its copies are copies of it.
+// The first signature is called through the thunk kept next to the buffer, the others through
+// a table of thunks shared by all objects of the callable type, so adding a signature costs
+// no allocation and no space in the object.
+template<std::size_t InlineBytes, std::size_t Align, typename... Signatures>
+struct basic_overloaded_function;
+
+template<std::size_t InlineBytes, std::size_t Align, typename R, typename... Args, typename... Signatures>
+struct basic_overloaded_function<InlineBytes, Align, R(Args...), Signatures...>
+        : overloaded_calls<basic_overloaded_function<InlineBytes, Align, R(Args...), Signatures...>,
+                std::make_index_sequence<1 + sizeof...(Signatures)>, R(Args...), Signatures...> {
+    static_assert(InlineBytes >= sizeof(void *) && Align % alignof(void *) == 0,
+                  "the inline buffer must be able to hold a pointer");
+
+    template<typename T>
+    static constexpr bool is_small = is_small_v<T, InlineBytes, Align>;
+
+    basic_overloaded_function() noexcept
+            : stg(get_empty_descriptor<R, Args...>()), thunks(get_empty_overloaded_thunks<R(Args...), Signatures...>()) {}
+
+    basic_overloaded_function(basic_overloaded_function const &other) = default;
+
+    basic_overloaded_function(basic_overloaded_function &&other) noexcept
+            : stg(std::move(other.stg)),
+              thunks(std::exchange(other.thunks, get_empty_overloaded_thunks<R(Args...), Signatures...>())) {}
+
+    template<typename T>
+    basic_overloaded_function(T val)
+            : basic_overloaded_function(std::allocator_arg, std::pmr::get_default_resource(), std::move(val)) {}
+
+    // A callable that is not stored inline is allocated from resource, and so are its copies.
+    template<typename T>
+    basic_overloaded_function(std::allocator_arg_t, std::pmr::memory_resource *resource, T val)
+            : stg(object_traits<T, is_small<T>>().template get_type_descriptor<R, Args ...>(),
+                  inline_size_v<T, InlineBytes, Align>),
+              thunks(get_overloaded_thunks<T, is_small<T>, R(Args...), Signatures...>()) {
+        if constexpr (is_small<T>) {
+            new(&stg.obj) T(std::move(val));
+        } else {
+            reinterpret_cast<heap_object<T> *&>(stg.obj) = heap_object<T>::create(resource, std::move(val));
+        }
+    }
+
+    basic_overloaded_function &operator=(basic_overloaded_function const &rhs) {
+        if (this != &rhs) {
+            basic_overloaded_function(rhs).swap(*this);
+        }
+        return *this;
+    }
+
+    basic_overloaded_function &operator=(basic_overloaded_function &&rhs) noexcept {
+        if (this != &rhs) {
+            stg = std::move(rhs.stg);
+            thunks = std::exchange(rhs.thunks, get_empty_overloaded_thunks<R(Args...), Signatures...>());
+        }
+        return *this;
+    }
+
+    ~basic_overloaded_function() = default;
+
+    void swap(basic_overloaded_function &other) noexcept {
+        stg.swap(other.stg);
+        std::swap(thunks, other.thunks);
+    }
+
+    friend void swap(basic_overloaded_function &a, basic_overloaded_function &b) noexcept {
+        a.swap(b);
+    }
+
+    explicit operator bool() const noexcept {
+        return stg.descr != get_empty_descriptor<R, Args...>();
+    }
+
+    // type_id of the stored callable, type_id<void>() if the function is empty.
+    type_id_t target_type() const noexcept {
+        return stg.descr->type;
+    }
+
+    template<typename T>
+    T *target() noexcept {
+        auto usual = object_traits<T, is_small<T>>().template get_type_descriptor<R, Args ...>();
+        return static_cast<T *>(stg.void_target(usual, type_id<T>()));
+    }
+
+    template<typename T>
+    T const *target() const noexcept {
+        auto usual = object_traits<T, is_small<T>>().template get_type_descriptor<R, Args ...>();
+        return static_cast<T const *>(stg.void_const_target(usual, type_id<T>()));
+    }
+
+private:
+    template<typename, std::size_t, typename>
+    friend struct overloaded_call;
+
+    // The descriptor of the first signature copies, moves and destroys the callable.
+    storage<InlineBytes, Align, R, Args...> stg;
+    overloaded_thunks<R(Args...), Signatures...> const *thunks;
+};
+
+template<typename... Signatures>
+using overloaded_function = basic_overloaded_function<sizeof(void *), alignof(void *), Signatures...>;
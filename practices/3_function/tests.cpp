@@ -1,5 +1,17 @@
 #include <gtest/gtest.h>
+#include "callable_pool.h"
 #include "function.h"
+#include "function_ref.h"
+#include "function_vector.h"
+#include "move_only_function.h"
+#include "overloaded_function.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST(function_test, default_ctor)
 {
@@ -398,6 +410,741 @@ TEST(function_test, target)
     EXPECT_NE(nullptr, std::as_const(f).target<bar>());
 }
 
+struct four_words
+{
+    int operator()() const noexcept
+    {
+        return static_cast<int>(a + b + c + d);
+    }
+
+    size_t a, b, c, d;
+};
+
+struct alignas(32) over_aligned
+{
+    int operator()() const noexcept
+    {
+        return value;
+    }
+
+    int value;
+};
+
+template <typename F, typename T>
+bool stored_inline(F const& f, T const* target)
+{
+    char const* begin = reinterpret_cast<char const*>(&f);
+    char const* p = reinterpret_cast<char const*>(target);
+    return p >= begin && p < begin + sizeof(f);
+}
+
+TEST(function_test, inline_buffer_size)
+{
+    EXPECT_FALSE((function<int ()>::is_small<four_words>));
+    EXPECT_TRUE((function<int (), 4 * sizeof(void*)>::is_small<four_words>));
+    EXPECT_FALSE((function<int (), 4 * sizeof(void*)>::is_small<over_aligned>));
+    EXPECT_TRUE((function<int (), 32, 32>::is_small<over_aligned>));
+    EXPECT_EQ(sizeof(function<int ()>) + 3 * sizeof(void*), sizeof(function<int (), 4 * sizeof(void*)>));
+}
+
+TEST(function_test, large_inline_buffer)
+{
+    using fn = function<int (), 4 * sizeof(void*)>;
+    fn f = four_words{1, 2, 3, 36};
+    EXPECT_TRUE(stored_inline(f, f.target<four_words>()));
+    fn g = f;
+    EXPECT_TRUE(stored_inline(g, g.target<four_words>()));
+    EXPECT_EQ(42, g());
+    fn h = large_func(7);
+    EXPECT_FALSE(stored_inline(h, h.target<large_func>()));
+    h.swap(g);
+    EXPECT_EQ(42, h());
+    EXPECT_EQ(7, g());
+    g = std::move(h);
+    EXPECT_EQ(42, g());
+    EXPECT_EQ(42, g.target<four_words>()->d + 6);
+}
+
+TEST(function_test, over_aligned_inline_buffer)
+{
+    function<int (), 32, 32> f = over_aligned{42};
+    EXPECT_TRUE(stored_inline(f, f.target<over_aligned>()));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(f.target<over_aligned>()) % 32);
+    function<int (), 32, 32> g = std::move(f);
+    EXPECT_EQ(42, g());
+}
+
+int twice(int x)
+{
+    return 2 * x;
+}
+
+int call_with_21(function_ref<int (int)> f)
+{
+    return f(21);
+}
+
+TEST(function_ref_test, two_words)
+{
+    EXPECT_EQ(2 * sizeof(void*), sizeof(function_ref<int (int)>));
+    EXPECT_TRUE(std::is_trivially_copyable_v<function_ref<int (int)>>);
+}
+
+TEST(function_ref_test, refers_to_callable)
+{
+    int calls = 0;
+    auto counter = [&calls](int x) mutable { return x + ++calls; };
+    function_ref<int (int)> f = counter;
+    EXPECT_EQ(11, f(10));
+    function_ref<int (int)> g = f;
+    EXPECT_EQ(12, g(10));
+    EXPECT_EQ(2, calls);
+    EXPECT_EQ(24, call_with_21(counter));
+}
+
+TEST(function_ref_test, functions)
+{
+    EXPECT_EQ(42, call_with_21(twice));
+    EXPECT_EQ(42, call_with_21(&twice));
+    function_ref<int (int)> f = &twice;
+    EXPECT_EQ(4, f(2));
+}
+
+TEST(function_ref_test, temporary_argument)
+{
+    four_words large{1, 2, 3, 4};
+    EXPECT_EQ(31, call_with_21([large](int x) { return x + large(); }));
+}
+
+TEST(function_ref_test, from_function)
+{
+    function<int (int)> small = [](int x) { return x + 21; };
+    EXPECT_EQ(42, call_with_21(small));
+    function<int ()> large = large_func(42);
+    function_ref<int ()> f = large;
+    EXPECT_EQ(42, f());
+    function_ref<int ()> g = std::as_const(large);
+    EXPECT_EQ(42, g());
+}
+
+TEST(function_ref_test, from_empty_function)
+{
+    function<int (int)> empty;
+    EXPECT_THROW(call_with_21(empty), bad_function_call);
+}
+
+TEST(function_ref_test, from_other_signature)
+{
+    function<long (long)> f = [](long x) { return x * 2; };
+    EXPECT_EQ(42, call_with_21(f));
+}
+
+TEST(function_ref_test, conversions)
+{
+    function_ref<void (int)> discard = twice;
+    discard(1);
+    function_ref<double (int)> widen = twice;
+    EXPECT_EQ(4.0, widen(2));
+}
+
+TEST(function_ref_test, move_only_arguments)
+{
+    auto take = [](std::unique_ptr<int> p, int& out) { out = *p; };
+    function_ref<void (std::unique_ptr<int>, int&)> f = take;
+    int out = 0;
+    f(std::make_unique<int>(42), out);
+    EXPECT_EQ(42, out);
+}
+
+struct move_only_large
+{
+    int operator()() const
+    {
+        return *value + static_cast<int>(padding[0]);
+    }
+
+    std::unique_ptr<int> value;
+    size_t padding[8] = {};
+};
+
+TEST(move_only_function_test, empty)
+{
+    move_only_function<int ()> f;
+    EXPECT_FALSE(static_cast<bool>(f));
+    EXPECT_THROW(f(), bad_function_call);
+    EXPECT_EQ(nullptr, f.target<small_func>());
+    EXPECT_FALSE(std::is_copy_constructible_v<move_only_function<int ()>>);
+    EXPECT_TRUE(std::is_nothrow_move_constructible_v<move_only_function<int ()>>);
+}
+
+TEST(move_only_function_test, move_only_capture)
+{
+    move_only_function<int (int)> f = [p = std::make_unique<int>(40)](int x) { return *p + x; };
+    EXPECT_TRUE(static_cast<bool>(f));
+    EXPECT_EQ(42, f(2));
+    move_only_function<int (int)> g = std::move(f);
+    EXPECT_FALSE(static_cast<bool>(f));
+    EXPECT_EQ(42, g(2));
+    f = std::move(g);
+    EXPECT_EQ(41, f(1));
+}
+
+TEST(move_only_function_test, larger_inline_buffer)
+{
+    auto task = [p = std::make_unique<int>(1), a = size_t(2), b = size_t(3)] { return *p + static_cast<int>(a + b); };
+    using task_t = decltype(task);
+    EXPECT_TRUE(move_only_function<int ()>::is_small<task_t>);
+    EXPECT_FALSE(function<int ()>::is_small<four_words>);
+    move_only_function<int ()> f = std::move(task);
+    EXPECT_TRUE(stored_inline(f, f.target<task_t>()));
+    move_only_function<int ()> g = std::move(f);
+    EXPECT_TRUE(stored_inline(g, g.target<task_t>()));
+    EXPECT_EQ(6, g());
+}
+
+TEST(move_only_function_test, large_callable)
+{
+    move_only_function<int ()> f = move_only_large{std::make_unique<int>(42)};
+    EXPECT_FALSE(stored_inline(f, f.target<move_only_large>()));
+    move_only_function<int ()> g = [] { return 7; };
+    f.swap(g);
+    EXPECT_EQ(7, f());
+    EXPECT_EQ(42, g());
+    EXPECT_EQ(42, *std::as_const(g).target<move_only_large>()->value);
+    EXPECT_EQ(nullptr, g.target<small_func>());
+}
+
+TEST(move_only_function_test, destroys_callable)
+{
+    auto resource = std::make_shared<int>(0);
+    {
+        move_only_function<void ()> small = [resource] {};
+        move_only_function<void ()> large = [resource, padding = four_words{}] {};
+        EXPECT_EQ(3, resource.use_count());
+        move_only_function<void ()> moved = std::move(large);
+        EXPECT_EQ(3, resource.use_count());
+        small = std::move(moved);
+        EXPECT_EQ(2, resource.use_count());
+    }
+    EXPECT_EQ(1, resource.use_count());
+}
+
+TEST(move_only_function_test, mutable_callable)
+{
+    move_only_function<int ()> counter = [n = std::make_unique<int>(0)]() mutable { return ++*n; };
+    counter();
+    EXPECT_EQ(2, counter());
+}
+
+TEST(move_only_function_test, task_queue)
+{
+    std::vector<move_only_function<void ()>> queue;
+    std::vector<int> done;
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.emplace_back([&done, p = std::make_unique<int>(i)] { done.push_back(*p); });
+    }
+    for (auto& task : queue)
+    {
+        task();
+    }
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), done);
+}
+
+struct counted
+{
+    counted() noexcept
+    {
+        ++alive;
+    }
+
+    counted(counted const&) noexcept
+    {
+        ++alive;
+    }
+
+    counted(counted&&) noexcept
+    {
+        ++alive;
+    }
+
+    ~counted()
+    {
+        --alive;
+    }
+
+    int operator()() const
+    {
+        return 42;
+    }
+
+    static int alive;
+};
+
+int counted::alive = 0;
+
+TEST(function_test, move_destroys_source)
+{
+    {
+        function<int ()> f = counted();
+        EXPECT_EQ(1, counted::alive);
+        function<int ()> g = std::move(f);
+        EXPECT_EQ(1, counted::alive);
+        function<int ()> h = [] { return 1; };
+        h.swap(g);
+        EXPECT_EQ(1, counted::alive);
+        EXPECT_EQ(42, h());
+        g = std::move(h);
+        EXPECT_EQ(1, counted::alive);
+    }
+    EXPECT_EQ(0, counted::alive);
+}
+
+TEST(function_test, relocation)
+{
+    using fn = function<int (), 4 * sizeof(void*)>;
+    std::vector<fn> functions;
+    for (int i = 0; i < 100; ++i)
+    {
+        if (i % 3 == 0)
+            functions.emplace_back(counted());
+        else if (i % 3 == 1)
+            functions.emplace_back(four_words{size_t(i), 0, 0, 0});
+        else
+            functions.emplace_back(large_func(i));
+    }
+    EXPECT_EQ(34, counted::alive);
+    std::rotate(functions.begin(), functions.begin() + 10, functions.end());
+    for (int i = 0; i < 100; ++i)
+    {
+        int j = (i + 10) % 100;
+        EXPECT_EQ(j % 3 == 0 ? 42 : j, functions[i]());
+    }
+    using std::swap;
+    swap(functions[0], functions[1]);
+    EXPECT_EQ(11, functions[0]());
+    functions.clear();
+    EXPECT_EQ(0, counted::alive);
+}
+
+struct counting_resource : std::pmr::memory_resource
+{
+    int allocations = 0;
+    int outstanding = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations;
+        ++outstanding;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        --outstanding;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+TEST(function_test, memory_resource)
+{
+    counting_resource resource;
+    {
+        function<int ()> f(std::allocator_arg, &resource, large_func(42));
+        EXPECT_EQ(1, resource.allocations);
+        EXPECT_EQ(42, f());
+        function<int ()> g = f;
+        EXPECT_EQ(2, resource.allocations);
+        function<int ()> h = std::move(g);
+        EXPECT_EQ(2, resource.allocations);
+        EXPECT_EQ(42, h.target<large_func>()->get_value());
+        function<int ()> small(std::allocator_arg, &resource, small_func(1));
+        EXPECT_EQ(2, resource.allocations);
+        EXPECT_EQ(2, resource.outstanding);
+    }
+    EXPECT_EQ(0, resource.outstanding);
+}
+
+TEST(move_only_function_test, memory_resource)
+{
+    counting_resource resource;
+    {
+        move_only_function<int ()> f(std::allocator_arg, &resource, move_only_large{std::make_unique<int>(42)});
+        move_only_function<int ()> g = std::move(f);
+        EXPECT_EQ(42, g());
+        EXPECT_EQ(1, resource.outstanding);
+    }
+    EXPECT_EQ(0, resource.outstanding);
+}
+
+TEST(callable_pool_test, recycles_blocks)
+{
+    counting_resource upstream;
+    callable_pool pool(&upstream);
+    void* a = pool.allocate(40);
+    void* b = pool.allocate(48);
+    EXPECT_EQ(1, upstream.allocations);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t));
+    pool.deallocate(a, 40);
+    EXPECT_EQ(a, pool.allocate(33));
+    void* c = pool.allocate(64);
+    EXPECT_NE(b, c);
+    pool.deallocate(b, 48);
+    pool.deallocate(c, 64);
+    EXPECT_EQ(c, pool.allocate(64));
+    EXPECT_EQ(1, upstream.allocations);
+    pool.release();
+    EXPECT_EQ(0, upstream.outstanding);
+}
+
+TEST(callable_pool_test, large_and_over_aligned_blocks)
+{
+    counting_resource upstream;
+    callable_pool pool(&upstream);
+    void* large = pool.allocate(callable_pool::max_size + 1);
+    EXPECT_EQ(1, upstream.outstanding);
+    void* aligned = pool.allocate(32, 64);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(aligned) % 64);
+    EXPECT_EQ(2, upstream.outstanding);
+    pool.deallocate(large, callable_pool::max_size + 1);
+    pool.deallocate(aligned, 32, 64);
+    EXPECT_EQ(0, upstream.outstanding);
+}
+
+TEST(callable_pool_test, function_copies_use_pool)
+{
+    counting_resource upstream;
+    {
+        callable_pool pool(&upstream);
+        std::vector<function<int ()>> functions;
+        for (int i = 0; i < 1000; ++i)
+        {
+            functions.emplace_back(std::allocator_arg, &pool, four_words{size_t(i), 0, 0, 0});
+            functions.push_back(functions.back());
+        }
+        EXPECT_EQ(999, functions.back()());
+        functions.clear();
+        for (int i = 0; i < 1000; ++i)
+        {
+            functions.emplace_back(std::allocator_arg, &pool, four_words{size_t(i), 0, 0, 0});
+        }
+        EXPECT_EQ(2000 * sizeof(heap_object<four_words>) / callable_pool::chunk_size + 1, size_t(upstream.allocations));
+    }
+    EXPECT_EQ(0, upstream.outstanding);
+}
+
+TEST(function_test, shared_storage)
+{
+    counting_resource resource;
+    {
+        function<int ()> f(std::allocator_arg, &resource, shared_storage, counted());
+        EXPECT_EQ(1, counted::alive);
+        std::vector<function<int ()>> copies(1000, f);
+        EXPECT_EQ(1, resource.allocations);
+        EXPECT_EQ(1, counted::alive);
+        EXPECT_EQ(42, copies.back()());
+        EXPECT_EQ(std::as_const(f).target<counted>(), std::as_const(copies[0]).target<counted>());
+        EXPECT_EQ(nullptr, f.target<counted>());
+        f = function<int ()>();
+        copies.resize(1);
+        EXPECT_EQ(42, copies[0]());
+        EXPECT_EQ(1, resource.outstanding);
+    }
+    EXPECT_EQ(0, resource.outstanding);
+    EXPECT_EQ(0, counted::alive);
+}
+
+TEST(function_test, shared_storage_small)
+{
+    function<int ()> f(shared_storage, small_func(7));
+    function<int ()> g = f;
+    EXPECT_EQ(7, g());
+    EXPECT_EQ(7, std::as_const(g).target<small_func>()->get_value());
+    EXPECT_EQ(nullptr, std::as_const(g).target<large_func>());
+}
+
+TEST(function_test, shared_storage_concurrent_copies)
+{
+    function<int ()> f(shared_storage, counted());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([f] {
+            for (int i = 0; i < 1000; ++i)
+            {
+                function<int ()> copy = f;
+                EXPECT_EQ(42, copy());
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(1, counted::alive);
+    f = function<int ()>();
+    EXPECT_EQ(0, counted::alive);
+}
+
+struct alignas(16) aligned_adder
+{
+    void operator()(std::vector<int>& out) const
+    {
+        out.push_back(value);
+    }
+
+    int value;
+};
+
+TEST(function_vector_test, invoke_all_in_order)
+{
+    function_vector<void (std::vector<int>&)> callbacks;
+    EXPECT_TRUE(callbacks.empty());
+    std::vector<int> out;
+    callbacks.invoke_all(out);
+    EXPECT_TRUE(out.empty());
+    callbacks.push_back([](std::vector<int>& out) { out.push_back(1); });
+    callbacks.push_back(aligned_adder{2});
+    four_words large{3, 0, 0, 0};
+    callbacks.push_back([large](std::vector<int>& out) { out.push_back(large()); });
+    callbacks.push_back([c = 'x'](std::vector<int>& out) { out.push_back(c == 'x' ? 4 : 0); });
+    EXPECT_EQ(4u, callbacks.size());
+    callbacks.invoke_all(out);
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4}), out);
+}
+
+TEST(function_vector_test, invoke)
+{
+    function_vector<int (int)> functions;
+    auto increment = functions.push_back([](int x) { return x + 1; });
+    auto twice = functions.push_back([](int x) { return x * 2; });
+    EXPECT_EQ(11, functions.invoke(increment, 10));
+    EXPECT_EQ(20, functions.invoke(twice, 10));
+}
+
+TEST(function_vector_test, growth_relocates)
+{
+    {
+        function_vector<int ()> functions;
+        std::vector<function_vector<int ()>::id_t> ids;
+        for (int i = 0; i < 1000; ++i)
+        {
+            if (i % 2 == 0)
+                ids.push_back(functions.push_back(counted()));
+            else
+                ids.push_back(functions.push_back([i] { return i; }));
+        }
+        EXPECT_EQ(500, counted::alive);
+        EXPECT_EQ(42, functions.invoke(ids[998]));
+        EXPECT_EQ(999, functions.invoke(ids[999]));
+    }
+    EXPECT_EQ(0, counted::alive);
+}
+
+TEST(function_vector_test, erase_and_compact)
+{
+    function_vector<void (std::vector<int>&)> callbacks;
+    std::vector<function_vector<void (std::vector<int>&)>::id_t> ids;
+    for (int i = 0; i < 10; ++i)
+    {
+        ids.push_back(callbacks.push_back(aligned_adder{i}));
+        ids.push_back(callbacks.push_back([i, tag = counted()](std::vector<int>& out) { out.push_back(100 + i); }));
+    }
+    EXPECT_EQ(10, counted::alive);
+    for (int i = 0; i < 10; ++i)
+    {
+        callbacks.erase(ids[2 * i + 1]);
+    }
+    EXPECT_EQ(0, counted::alive);
+    EXPECT_EQ(10u, callbacks.size());
+    callbacks.erase(ids[0]);
+    std::vector<int> out;
+    callbacks.invoke_all(out);
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9}), out);
+
+    std::size_t before = callbacks.bytes_used();
+    callbacks.compact();
+    EXPECT_LT(callbacks.bytes_used(), before);
+    out.clear();
+    callbacks.invoke_all(out);
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9}), out);
+    out.clear();
+    callbacks.invoke(ids[18], out);
+    EXPECT_EQ(std::vector<int>({9}), out);
+
+    auto reused = callbacks.push_back(aligned_adder{10});
+    EXPECT_EQ(10u, callbacks.size());
+    out.clear();
+    callbacks.invoke(reused, out);
+    callbacks.invoke_all(out);
+    EXPECT_EQ(std::vector<int>({10, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), out);
+}
+
+TEST(function_vector_test, move_and_clear)
+{
+    function_vector<int ()> a;
+    auto id = a.push_back(counted());
+    function_vector<int ()> b = std::move(a);
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(42, b.invoke(id));
+    a = std::move(b);
+    EXPECT_EQ(1, counted::alive);
+    a.clear();
+    EXPECT_EQ(0, counted::alive);
+    a.push_back(counted());
+    EXPECT_EQ(1u, a.size());
+    a = function_vector<int ()>();
+    EXPECT_EQ(0, counted::alive);
+}
+
+TEST(function_test, target_type)
+{
+    function<int ()> empty;
+    EXPECT_EQ(type_id<void>(), empty.target_type());
+    function<int ()> small = small_func(1);
+    function<int ()> large = large_func(2);
+    function<int (), 64> inline_large = large_func(3);
+    function<int ()> shared(shared_storage, large_func(4));
+    EXPECT_EQ(type_id<small_func>(), small.target_type());
+    EXPECT_EQ(type_id<large_func>(), large.target_type());
+    EXPECT_EQ(type_id<large_func>(), inline_large.target_type());
+    EXPECT_EQ(type_id<large_func>(), shared.target_type());
+    EXPECT_NE(type_id<small_func>(), type_id<large_func>());
+    EXPECT_EQ(3, inline_large.target<large_func>()->get_value());
+    EXPECT_EQ(4, std::as_const(shared).target<large_func>()->get_value());
+    EXPECT_EQ(nullptr, shared.target<large_func>());
+    EXPECT_EQ(nullptr, std::as_const(shared).target<small_func>());
+}
+
+TEST(move_only_function_test, target_type)
+{
+    move_only_function<int ()> f;
+    EXPECT_EQ(type_id<void>(), f.target_type());
+    f = move_only_large{std::make_unique<int>(42)};
+    EXPECT_EQ(type_id<move_only_large>(), f.target_type());
+    EXPECT_EQ(42, *f.target<move_only_large>()->value);
+    EXPECT_EQ(nullptr, f.target<small_func>());
+}
+
+struct key_event
+{
+    int key;
+};
+
+struct mouse_event
+{
+    int x;
+    int y;
+};
+
+struct event_handler
+{
+    int operator()(key_event e)
+    {
+        return base + e.key;
+    }
+
+    std::string operator()(mouse_event e)
+    {
+        return std::to_string(e.x) + "," + std::to_string(e.y);
+    }
+
+    void operator()() const
+    {}
+
+    int base;
+};
+
+TEST(overloaded_function_test, dispatches_on_arguments)
+{
+    overloaded_function<int (key_event), std::string (mouse_event)> f = event_handler{10};
+    EXPECT_TRUE(static_cast<bool>(f));
+    EXPECT_EQ(13, f(key_event{3}));
+    EXPECT_EQ("1,2", f(mouse_event{1, 2}));
+    EXPECT_EQ(type_id<event_handler>(), f.target_type());
+    f.target<event_handler>()->base = 20;
+    EXPECT_EQ(23, f(key_event{3}));
+}
+
+TEST(overloaded_function_test, generic_lambda)
+{
+    overloaded_function<int (int), int (std::string const&), int ()> f = [](auto const&... args) {
+        return (0 + ... + int(sizeof(args)));
+    };
+    EXPECT_EQ(int(sizeof(int)), f(1));
+    EXPECT_EQ(int(sizeof(std::string)), f(std::string("abc")));
+    EXPECT_EQ(0, f());
+}
+
+TEST(overloaded_function_test, empty)
+{
+    overloaded_function<int (key_event), std::string (mouse_event)> f;
+    EXPECT_FALSE(static_cast<bool>(f));
+    EXPECT_EQ(type_id<void>(), f.target_type());
+    EXPECT_THROW(f(key_event{1}), bad_function_call);
+    EXPECT_THROW(f(mouse_event{1, 2}), bad_function_call);
+}
+
+TEST(overloaded_function_test, copy_move_swap)
+{
+    using handler_t = overloaded_function<int (key_event), std::string (mouse_event)>;
+    handler_t f = event_handler{1};
+    handler_t g = f;
+    g.target<event_handler>()->base = 2;
+    EXPECT_EQ(1, f(key_event{0}));
+    EXPECT_EQ(2, g(key_event{0}));
+    handler_t h = std::move(g);
+    EXPECT_FALSE(static_cast<bool>(g));
+    EXPECT_THROW(g(mouse_event{0, 0}), bad_function_call);
+    EXPECT_EQ("0,0", h(mouse_event{0, 0}));
+    swap(f, h);
+    EXPECT_EQ(2, f(key_event{0}));
+    EXPECT_EQ(1, h(key_event{0}));
+    f = std::move(h);
+    EXPECT_EQ(1, f(key_event{0}));
+    EXPECT_FALSE(static_cast<bool>(h));
+    h = f;
+    EXPECT_EQ("3,4", h(mouse_event{3, 4}));
+}
+
+TEST(overloaded_function_test, one_allocation_for_all_signatures)
+{
+    counting_resource resource;
+    {
+        std::array<int, 16> payload{};
+        payload[0] = 5;
+        overloaded_function<int (key_event), int (mouse_event)> f(std::allocator_arg, &resource, [payload](auto e) {
+            return payload[0] + int(sizeof(e));
+        });
+        EXPECT_EQ(1, resource.allocations);
+        EXPECT_EQ(5 + int(sizeof(key_event)), f(key_event{0}));
+        EXPECT_EQ(5 + int(sizeof(mouse_event)), f(mouse_event{0, 0}));
+        auto g = f;
+        EXPECT_EQ(2, resource.allocations);
+    }
+    EXPECT_EQ(0, resource.outstanding);
+    EXPECT_EQ(sizeof(function<int ()>) + sizeof(void*), sizeof(overloaded_function<int (key_event), int (mouse_event)>));
+}
+
+TEST(overloaded_function_test, destroys_callable)
+{
+    {
+        overloaded_function<void (), void (int)> f = [c = counted()](auto...) {};
+        auto g = f;
+        EXPECT_EQ(2, counted::alive);
+        auto h = std::move(g);
+        EXPECT_EQ(2, counted::alive);
+    }
+    EXPECT_EQ(0, counted::alive);
+}
+
 int main(int argc, char *argv[])
 {
     testing::InitGoogleTest(&argc, argv);
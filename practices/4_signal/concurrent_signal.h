@@ -0,0 +1,235 @@
+#pragma once
+
+#include "event_loop.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace signals {
+    // Counts emissions in progress so that a writer can wait until none of them uses an old
+    // snapshot. Each thread counts on its own stripe, so emitters do not contend for a cache line.
+    // Emissions started before a flip of the epoch count on its old parity, so waiting for both
+    // parities to drain one after another cannot be postponed forever by new emissions.
+    struct emission_counter {
+        static constexpr std::size_t stripes = 16;
+
+        struct scope {
+            explicit scope(emission_counter const &counter) noexcept
+                    : count(counter.enter()) {
+                ++depth();
+            }
+
+            scope(scope const &) = delete;
+
+            scope &operator=(scope const &) = delete;
+
+            ~scope() {
+                --depth();
+                count.fetch_sub(1);
+            }
+
+        private:
+            std::atomic<std::size_t> &count;
+        };
+
+        // Whether the calling thread is inside an emission of any concurrent_signal, so that
+        // waiting for emissions to finish would wait for itself.
+        static bool in_emission() noexcept {
+            return depth() != 0;
+        }
+
+        // Returns once all emissions that started before the call have finished.
+        void synchronize() const {
+            std::lock_guard<std::mutex> lock(synchronize_mutex);
+            for (int phase = 0; phase < 2; ++phase) {
+                unsigned parity = epoch.fetch_add(1) & 1;
+                for (stripe const &s : counts) {
+                    while (s.count[parity].load() != 0) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+
+    private:
+        struct alignas(64) stripe {
+            std::atomic<std::size_t> count[2] = {};
+        };
+
+        static std::size_t &depth() noexcept {
+            static thread_local std::size_t emissions = 0;
+            return emissions;
+        }
+
+        static std::size_t this_thread_stripe() noexcept {
+            static std::atomic<std::size_t> threads{0};
+            static thread_local std::size_t index = threads.fetch_add(1, std::memory_order_relaxed) % stripes;
+            return index;
+        }
+
+        // All operations are sequentially consistent: an emission either is counted when
+        // a writer looks at its stripe, or loads the snapshot published before that.
+        std::atomic<std::size_t> &enter() const noexcept {
+            std::atomic<std::size_t> &count = counts[this_thread_stripe()].count[epoch.load() & 1];
+            count.fetch_add(1);
+            return count;
+        }
+
+        mutable stripe counts[stripes];
+        mutable std::atomic<unsigned> epoch{0};
+        mutable std::mutex synchronize_mutex;
+    };
+
+    template<typename T>
+    struct concurrent_signal;
+
+    // signal that may be emitted, connected to and disconnected from by many threads at once.
+    // An emission calls the slots of an immutable snapshot of the connections without locking;
+    // connect() and disconnect() publish a new snapshot under a mutex, and the old one is freed
+    // once emissions that might use it have finished. A slot disconnected during an emission is
+    // not called by it, and one connected during an emission is called by later ones only.
+    // Unless called from a slot, disconnect() returns after emissions in progress have finished,
+    // so that the slot can no longer run; a slot must not wait for a thread that connects or
+    // disconnects. The signal must not be destroyed while it is emitted.
+    template<typename... Args>
+    struct concurrent_signal<void(Args...)> {
+        using slot_t = std::function<void(Args...)>;
+
+    private:
+        struct slot_node {
+            slot_node(concurrent_signal *sig, slot_t slot) : sig(sig), slot(std::move(slot)) {}
+
+            concurrent_signal *sig;
+            slot_t slot;
+            std::atomic<bool> connected{true};
+        };
+
+        using snapshot_t = std::vector<std::shared_ptr<slot_node>>;
+
+    public:
+        struct connection {
+            connection() noexcept = default;
+
+            connection(connection const &) = delete;
+
+            connection &operator=(connection const &) = delete;
+
+            connection(connection &&other) noexcept = default;
+
+            connection &operator=(connection &&other) noexcept {
+                if (this != &other) {
+                    disconnect();
+                    node = std::move(other.node);
+                }
+                return *this;
+            }
+
+            ~connection() {
+                disconnect();
+            }
+
+            void disconnect() {
+                if (node == nullptr) return;
+                if (node->sig != nullptr) {
+                    node->sig->remove(*node);
+                }
+                node.reset();
+            }
+
+        private:
+            friend struct concurrent_signal;
+
+            explicit connection(std::shared_ptr<slot_node> node) noexcept: node(std::move(node)) {}
+
+            std::shared_ptr<slot_node> node;
+        };
+
+        concurrent_signal() = default;
+
+        concurrent_signal(concurrent_signal const &) = delete;
+
+        concurrent_signal &operator=(concurrent_signal const &) = delete;
+
+        ~concurrent_signal() {
+            std::unique_ptr<snapshot_t const> last(current.load());
+            for (auto const &node : *last) {
+                node->connected.store(false);
+                node->sig = nullptr;
+            }
+        }
+
+        connection connect(slot_t slot) {
+            auto node = std::make_shared<slot_node>(this, std::move(slot));
+            std::unique_lock<std::mutex> lock(writer_mutex);
+            auto next = std::make_unique<snapshot_t>(*current.load());
+            next->push_back(node);
+            publish(std::move(next), lock, retired.size() >= max_retired);
+            return connection(std::move(node));
+        }
+
+        // Queued connection: emissions post calls of slot to executor, see queued_slot.
+        template<typename Executor>
+        connection connect(Executor &executor, slot_t slot) {
+            return connect(queued_slot<Args...>(executor, std::move(slot)));
+        }
+
+        // Like signal, passes the arguments as lvalues to all slots but the last.
+        void operator()(Args... args) const {
+            emission_counter::scope emission(emissions);
+            snapshot_t const &slots = *current.load();
+            for (std::size_t i = 0; i != slots.size(); ++i) {
+                slot_node const &node = *slots[i];
+                if (!node.connected.load())
+                    continue;
+                if constexpr (copyable_arguments_v<Args...>) {
+                    if (i + 1 != slots.size()) {
+                        node.slot(args...);
+                    } else {
+                        node.slot(std::forward<Args>(args)...);
+                    }
+                } else {
+                    node.slot(std::forward<Args>(args)...);
+                }
+            }
+        }
+
+    private:
+        void remove(slot_node &node) {
+            std::unique_lock<std::mutex> lock(writer_mutex);
+            if (!node.connected.exchange(false)) return;
+            snapshot_t const &slots = *current.load();
+            auto next = std::make_unique<snapshot_t>();
+            next->reserve(slots.size() - 1);
+            for (auto const &other : slots) {
+                if (other.get() != &node) {
+                    next->push_back(other);
+                }
+            }
+            publish(std::move(next), lock, true);
+        }
+
+        // Replaced snapshots are freed after waiting for emissions, so that connect() waits only
+        // when max_retired of them have piled up. Those replaced during an emission on this thread
+        // are kept until a later wait outside of one, since waiting would wait for the emission itself.
+        void publish(std::unique_ptr<snapshot_t> next, std::unique_lock<std::mutex> &lock, bool wait) {
+            retired.emplace_back(current.exchange(next.release()));
+            if (!wait || emission_counter::in_emission()) return;
+            std::vector<std::unique_ptr<snapshot_t const>> garbage;
+            garbage.swap(retired);
+            lock.unlock();
+            emissions.synchronize();
+        }
+
+        static constexpr std::size_t max_retired = 16;
+
+        std::atomic<snapshot_t const *> current{new snapshot_t()};
+        emission_counter emissions;
+        std::mutex writer_mutex;
+        std::vector<std::unique_ptr<snapshot_t const>> retired;
+    };
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "event_loop.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace signals {
+    template<typename T>
+    struct dense_signal;
+
+    // signal that keeps its slots next to each other in a vector, so that an emission reads them
+    // in order instead of walking connections scattered over the heap. A connection is a handle:
+    // an index into a table of slot positions and the generation of that entry, which is bumped
+    // when the slot is disconnected, so a stale handle is recognised. A disconnected slot leaves
+    // a tombstone that emissions skip; tombstones are dropped and the vector is compacted only
+    // between emissions, once they make up half of it.
+    //
+    // Emission gives the guarantees of signal: a slot may disconnect any connection, emit again or
+    // destroy the signal, and a slot disconnected during an emission is not called by it. Slots
+    // are not moved or destroyed while an emission may be calling them. A slot connected during
+    // an emission is called by later ones only.
+    template<typename... Args>
+    struct dense_signal<void(Args...)> {
+        using slot_t = std::function<void(Args...)>;
+
+    private:
+        using handle_t = std::uint32_t;
+
+        static constexpr handle_t tombstone = handle_t(-1);
+
+        struct entry {
+            slot_t slot;
+            handle_t handle; // tombstone once disconnected
+        };
+
+        struct handle_entry {
+            std::uint32_t position; // in slots followed by pending
+            std::uint32_t generation;
+        };
+
+    public:
+        struct connection {
+            connection() noexcept = default;
+
+            connection(connection const &) = delete;
+
+            connection &operator=(connection const &) = delete;
+
+            connection(connection &&other) noexcept
+                    : sig(std::move(other.sig)), handle(other.handle), generation(other.generation) {}
+
+            connection &operator=(connection &&other) noexcept {
+                if (this != &other) {
+                    disconnect();
+                    sig = std::move(other.sig);
+                    handle = other.handle;
+                    generation = other.generation;
+                }
+                return *this;
+            }
+
+            ~connection() {
+                disconnect();
+            }
+
+            void disconnect() noexcept {
+                if (sig == nullptr) return;
+                if (*sig != nullptr) {
+                    (*sig)->remove(handle, generation);
+                }
+                sig.reset();
+            }
+
+        private:
+            friend struct dense_signal;
+
+            connection(std::shared_ptr<dense_signal *> sig, handle_t handle, std::uint32_t generation) noexcept
+                    : sig(std::move(sig)), handle(handle), generation(generation) {}
+
+            // Shared with the signal, which sets it to nullptr when it is destroyed.
+            std::shared_ptr<dense_signal *> sig;
+            handle_t handle = 0;
+            std::uint32_t generation = 0;
+        };
+
+    private:
+        struct iteration_token {
+            explicit iteration_token(dense_signal const *sig) noexcept: sig(sig), next(sig->top_token) {
+                sig->top_token = this;
+            }
+
+            iteration_token(iteration_token const &) = delete;
+
+            iteration_token &operator=(iteration_token const &) = delete;
+
+            ~iteration_token() {
+                if (sig == nullptr) return;
+                sig->top_token = next;
+                if (next == nullptr && sig->untidy) {
+                    const_cast<dense_signal *>(sig)->tidy();
+                }
+            }
+
+            dense_signal const *sig;
+            iteration_token *next;
+            // Slots of the signal destroyed during the emission, kept until it unwinds.
+            std::vector<entry> orphans;
+        };
+
+    public:
+        dense_signal() : self(std::make_shared<dense_signal *>(this)) {}
+
+        dense_signal(dense_signal const &) = delete;
+
+        dense_signal &operator=(dense_signal const &) = delete;
+
+        ~dense_signal() {
+            *self = nullptr;
+            if (top_token == nullptr) return;
+            iteration_token *outermost = top_token;
+            for (iteration_token *tok = top_token; tok != nullptr; tok = tok->next) {
+                tok->sig = nullptr;
+                outermost = tok;
+            }
+            outermost->orphans = std::move(slots);
+        }
+
+        connection connect(slot_t slot) {
+            // slots must not grow under an emission, which may be calling one of them;
+            // pending gets room for all slots, so that tidy() can merge them in its buffer
+            bool emitting = top_token != nullptr;
+            std::vector<entry> &target = emitting ? pending : slots;
+            make_room(target, emitting ? slots.size() + pending.size() + 1 : slots.size() + 1);
+            if (free_handles.empty()) {
+                make_room(handles, handles.size() + 1);
+                make_room(free_handles, handles.size() + 1);
+            }
+            // nothing below throws
+            handle_t handle;
+            if (free_handles.empty()) {
+                handle = static_cast<handle_t>(handles.size());
+                handles.push_back({0, 0});
+            } else {
+                handle = free_handles.back();
+                free_handles.pop_back();
+            }
+            handles[handle].position = static_cast<std::uint32_t>(slots.size() + pending.size());
+            target.push_back({std::move(slot), handle});
+            untidy = untidy || emitting;
+            return connection(self, handle, handles[handle].generation);
+        }
+
+        // Queued connection: emissions post calls of slot to executor, see queued_slot.
+        template<typename Executor>
+        connection connect(Executor &executor, slot_t slot) {
+            return connect(queued_slot<Args...>(executor, std::move(slot)));
+        }
+
+        // Like signal, passes the arguments as lvalues to all slots but the last.
+        void operator()(Args... args) const {
+            iteration_token token(this);
+            for (std::size_t i = 0, size = slots.size(); i != size; ++i) {
+                entry const &e = slots[i];
+                if (e.handle == tombstone)
+                    continue;
+                if constexpr (copyable_arguments_v<Args...>) {
+                    if (i + 1 != size) {
+                        e.slot(args...);
+                    } else {
+                        e.slot(std::forward<Args>(args)...);
+                    }
+                } else {
+                    e.slot(std::forward<Args>(args)...);
+                }
+                if (token.sig == nullptr)
+                    return;
+            }
+        }
+
+        // Number of connected slots.
+        std::size_t size() const noexcept {
+            return slots.size() + pending.size() - tombstones;
+        }
+
+    private:
+        template<typename T>
+        static void make_room(std::vector<T> &v, std::size_t size) {
+            if (v.capacity() < size) {
+                v.reserve(std::max(size, 2 * v.capacity()));
+            }
+        }
+
+        // Does not allocate: free_handles has room for every handle.
+        void remove(handle_t handle, std::uint32_t generation) noexcept {
+            handle_entry &h = handles[handle];
+            if (h.generation != generation) return;
+            ++h.generation;
+            free_handles.push_back(handle);
+            entry &e = h.position < slots.size() ? slots[h.position] : pending[h.position - slots.size()];
+            e.handle = tombstone;
+            ++tombstones;
+            if (top_token != nullptr) {
+                untidy = true;
+                return;
+            }
+            e.slot = slot_t();
+            if (2 * tombstones > slots.size()) {
+                tidy();
+            }
+        }
+
+        // Called outside of emissions: appends slots connected during them and drops tombstones.
+        // Does not allocate: the slots are merged in the buffer of pending, which connect() has
+        // made large enough, and compacted in place. Positions of pending slots already count
+        // the slots before them.
+        void tidy() noexcept {
+            if (!pending.empty()) {
+                std::size_t connected = pending.size();
+                pending.resize(slots.size() + connected);
+                std::move_backward(pending.begin(), pending.begin() + connected, pending.end());
+                std::move(slots.begin(), slots.end(), pending.begin());
+                slots.swap(pending);
+                pending.clear();
+            }
+            std::size_t live = 0;
+            for (entry &e : slots) {
+                if (e.handle == tombstone)
+                    continue;
+                handles[e.handle].position = static_cast<std::uint32_t>(live);
+                if (&slots[live] != &e) {
+                    slots[live] = std::move(e);
+                }
+                ++live;
+            }
+            slots.erase(slots.begin() + live, slots.end());
+            tombstones = 0;
+            untidy = false;
+        }
+
+        std::vector<entry> slots;
+        std::vector<entry> pending; // connected during an emission
+        std::vector<handle_entry> handles;
+        std::vector<handle_t> free_handles;
+        std::size_t tombstones = 0;
+        bool untidy = false;
+        std::shared_ptr<dense_signal *> self;
+        mutable iteration_token *top_token = nullptr;
+    };
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace signals {
+    // Queue of tasks run by the thread that calls run(), posted to from any thread. The loop takes
+    // all pending tasks at once and runs them without holding the lock, and post() wakes it up only
+    // when it sleeps on an empty queue, so a burst of posts costs a single wake-up.
+    struct event_loop {
+        event_loop() = default;
+
+        event_loop(event_loop const &) = delete;
+
+        event_loop &operator=(event_loop const &) = delete;
+
+        template<typename F>
+        void post(F f) {
+            auto t = std::make_unique<task<F>>(std::move(f));
+            bool wake;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                wake = sleeping && pending.empty();
+                pending.push_back(std::move(t));
+            }
+            if (wake) {
+                wakeup_count.fetch_add(1, std::memory_order_relaxed);
+                cv.notify_one();
+            }
+        }
+
+        // Runs tasks as they are posted until stop(). Tasks left when it returns stay queued.
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopped) {
+                if (pending.empty()) {
+                    sleeping = true;
+                    cv.wait(lock, [this] { return stopped || !pending.empty(); });
+                    sleeping = false;
+                    continue;
+                }
+                run_batch(lock);
+            }
+            stopped = false;
+        }
+
+        // Runs the tasks posted so far, for a thread that polls the loop instead of blocking in run().
+        std::size_t run_pending() {
+            std::unique_lock<std::mutex> lock(mutex);
+            return run_batch(lock);
+        }
+
+        // Makes run() return once the batch it runs is done. If no thread is in run(),
+        // the next call returns at once.
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopped = true;
+            }
+            cv.notify_all();
+        }
+
+        // How many times post() has woken the loop up.
+        std::size_t wakeups() const noexcept {
+            return wakeup_count.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct task_base {
+            virtual ~task_base() = default;
+
+            virtual void run() = 0;
+        };
+
+        template<typename F>
+        struct task : task_base {
+            explicit task(F f) : f(std::move(f)) {}
+
+            void run() override {
+                f();
+            }
+
+            F f;
+        };
+
+        using tasks_t = std::vector<std::unique_ptr<task_base>>;
+
+        // Called and returns with lock held. If a task throws, the rest of the batch is queued again.
+        std::size_t run_batch(std::unique_lock<std::mutex> &lock) {
+            tasks_t batch;
+            batch.swap(pending);
+            lock.unlock();
+            std::size_t done = 0;
+            try {
+                for (; done != batch.size(); ++done) {
+                    batch[done]->run();
+                }
+            } catch (...) {
+                lock.lock();
+                pending.insert(pending.begin(), std::make_move_iterator(batch.begin() + done + 1),
+                               std::make_move_iterator(batch.end()));
+                throw;
+            }
+            lock.lock();
+            return done;
+        }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        tasks_t pending;
+        bool sleeping = false;
+        bool stopped = false;
+        std::atomic<std::size_t> wakeup_count{0};
+    };
+
+    // Whether the arguments of an emission can be passed to a slot as lvalues, so that a slot taking
+    // one by value copies it. Signals pass them so to all slots but the last, which may take them
+    // over, so a slot does not get what an earlier one has moved from. Otherwise, e.g. with a
+    // unique_ptr, all slots get them forwarded.
+    template<typename... Args>
+    inline constexpr bool copyable_arguments_v = ((std::is_lvalue_reference_v<Args> ||
+                                                   (!std::is_reference_v<Args> && std::is_copy_constructible_v<Args>)) && ...);
+
+    // Slot that posts each call to executor, with the arguments moved into it, instead of making
+    // it, like a queued connection in Qt. Executor has post(F) taking a callable with no arguments;
+    // event_loop will do. Calls still queued once the returned slot and its copies are destroyed,
+    // i.e. after disconnect, are dropped; one already running is not waited for. The executor
+    // must outlive the slot and the calls posted to it.
+    template<typename... Args, typename Executor>
+    std::function<void(Args...)> queued_slot(Executor &executor, std::function<void(Args...)> slot) {
+        static_assert(((!std::is_lvalue_reference_v<Args> || std::is_const_v<std::remove_reference_t<Args>>) && ...),
+                      "a queued call cannot refer to the arguments of the emission");
+
+        struct state {
+            explicit state(std::function<void(Args...)> slot) : slot(std::move(slot)) {}
+
+            std::function<void(Args...)> slot;
+            std::atomic<bool> connected{true};
+        };
+
+        // Shared by the copies of the returned slot, unlike state, which the queued calls share too.
+        struct owner {
+            explicit owner(std::function<void(Args...)> slot) : shared(std::make_shared<state>(std::move(slot))) {}
+
+            ~owner() {
+                shared->connected.store(false);
+            }
+
+            std::shared_ptr<state> shared;
+        };
+
+        auto slot_owner = std::make_shared<owner>(std::move(slot));
+        return [&executor, slot_owner](Args... args) {
+            executor.post([shared = slot_owner->shared, values = std::tuple<std::decay_t<Args>...>(
+                    std::forward<Args>(args)...)]() mutable {
+                if (shared->connected.load()) {
+                    std::apply([&shared](auto &... value) { shared->slot(std::move(value)...); }, values);
+                }
+            });
+        };
+    }
+}
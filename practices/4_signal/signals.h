@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <iterator>
+#include "event_loop.h"
 #include "intrusive_list.h"
 
 namespace signals {
@@ -120,9 +122,25 @@ namespace signals {
             return connection(this, std::move(slot));
         }
 
+        // Queued connection: emissions post calls of slot to executor, see queued_slot.
+        template<typename Executor>
+        connection connect(Executor &executor, std::function<void(Args...)> slot) {
+            return connection(this, queued_slot<Args...>(executor, std::move(slot)));
+        }
+
+        // Slots get the arguments as lvalues but the last, see copyable_arguments_v. A slot
+        // connected by the last one during the emission gets what that one has left of them.
         void operator()(Args... args) const {
             for (iteration_token current_token(this); current_token.it != connections.end(); ++current_token.it) {
-                current_token.it->slot(std::forward<Args>(args) ...);
+                if constexpr (copyable_arguments_v<Args...>) {
+                    if (std::next(current_token.it) != connections.end()) {
+                        current_token.it->slot(args...);
+                    } else {
+                        current_token.it->slot(std::forward<Args>(args)...);
+                    }
+                } else {
+                    current_token.it->slot(std::forward<Args>(args)...);
+                }
                 if (current_token.sig == nullptr)
                     return;
             }
@@ -0,0 +1,260 @@
+#include "concurrent_signal.h"
+#include "dense_signal.h"
+#include "event_loop.h"
+#include "signals.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::size_t const slots = 4;
+
+    thread_local std::size_t sink = 0;
+
+    void slot(std::size_t x) {
+        sink += x;
+    }
+
+    // signal made thread-safe the simple way, for comparison.
+    struct locked_signal {
+        using connection = signals::signal<void(std::size_t)>::connection;
+
+        connection connect(std::function<void(std::size_t)> slot) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return sig.connect(std::move(slot));
+        }
+
+        void disconnect(connection &conn) {
+            std::lock_guard<std::mutex> lock(mutex);
+            conn.disconnect();
+        }
+
+        void operator()(std::size_t x) {
+            std::lock_guard<std::mutex> lock(mutex);
+            sig(x);
+        }
+
+        std::mutex mutex;
+        signals::signal<void(std::size_t)> sig;
+    };
+
+    struct concurrent {
+        using connection = signals::concurrent_signal<void(std::size_t)>::connection;
+
+        connection connect(std::function<void(std::size_t)> slot) {
+            return sig.connect(std::move(slot));
+        }
+
+        void disconnect(connection &conn) {
+            conn.disconnect();
+        }
+
+        void operator()(std::size_t x) {
+            sig(x);
+        }
+
+        signals::concurrent_signal<void(std::size_t)> sig;
+    };
+
+    // Emitters share the emissions equally; with churn, another thread keeps connecting and
+    // disconnecting a slot until they are done. Returns the wall time of the emitters.
+    template<typename Signal>
+    double run(std::size_t emitters, std::size_t emissions, bool churn) {
+        Signal sig;
+        std::vector<typename Signal::connection> connections;
+        for (std::size_t i = 0; i < slots; ++i) {
+            connections.push_back(sig.connect(slot));
+        }
+        std::atomic<std::size_t> ready{0};
+        std::atomic<bool> done{false};
+        std::thread writer;
+        if (churn) {
+            writer = std::thread([&] {
+                while (!done.load()) {
+                    auto conn = sig.connect(slot);
+                    sig.disconnect(conn);
+                }
+            });
+        }
+        std::vector<std::thread> threads;
+        std::size_t per_thread = emissions / emitters;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t t = 0; t < emitters; ++t) {
+            threads.emplace_back([&] {
+                ++ready;
+                while (ready.load() != emitters) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < per_thread; ++i) {
+                    sig(i);
+                }
+            });
+        }
+        for (std::thread &t : threads) {
+            t.join();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        done = true;
+        if (writer.joinable()) {
+            writer.join();
+        }
+        return std::chrono::duration<double, std::nano>(elapsed).count();
+    }
+
+    template<typename Signal>
+    void bench(std::string const &name, std::size_t emitters, std::size_t emissions, bool churn) {
+        double best = 0;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            double ns = run<Signal>(emitters, emissions, churn);
+            best = repeat == 0 ? ns : std::min(best, ns);
+        }
+        std::string full_name = "emit/" + name + "/emitters:" + std::to_string(emitters) + (churn ? "/churn" : "");
+        std::printf("%-50s %10zu emissions %10.3f ms %8.2f ns/emission %8.2f M emissions/s\n",
+                    full_name.c_str(), emissions, best / 1e6, best / emissions, emissions * 1e3 / best);
+    }
+
+    // Stands for a handler too slow to run on a network thread.
+    void expensive_slot(std::size_t x) {
+        volatile std::size_t acc = x;
+        for (int i = 0; i < 1000; ++i) {
+            acc = acc * 31 + i;
+        }
+        sink += acc;
+    }
+
+    void report(std::string const &name, std::size_t emissions, double ns, std::size_t wakeups) {
+        std::printf("%-50s %10zu emissions %10.3f ms %8.2f ns/emission %8.4f wakeups/emission\n",
+                    name.c_str(), emissions, ns / 1e6, ns / emissions, double(wakeups) / emissions);
+    }
+
+    double since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Time the emitting thread spends in emissions when the handler runs on it and when it is
+    // queued to an event loop run by another thread, and how often that thread is woken up.
+    // Emissions come in bursts with pauses in between, like messages read from a socket.
+    template<typename Connect>
+    void bench_bursts(std::string const &name, std::size_t emissions, std::size_t burst, Connect connect) {
+        signals::event_loop loop;
+        std::thread consumer([&loop] { loop.run(); });
+        signals::signal<void(std::size_t)> sig;
+        auto conn = connect(sig, loop);
+        double emit_ns = 0;
+        for (std::size_t i = 0; i < emissions; i += burst) {
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t j = i; j < std::min(i + burst, emissions); ++j) {
+                sig(j);
+            }
+            emit_ns += since(start);
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        std::promise<void> drained;
+        loop.post([&drained] { drained.set_value(); });
+        drained.get_future().wait();
+        loop.stop();
+        consumer.join();
+        report("emit/" + name + "/burst:" + std::to_string(burst), emissions, emit_ns, loop.wakeups());
+    }
+
+    void bench_queued(std::size_t emissions) {
+        auto direct = [](signals::signal<void(std::size_t)> &sig, signals::event_loop &) {
+            return sig.connect(expensive_slot);
+        };
+        auto queued = [](signals::signal<void(std::size_t)> &sig, signals::event_loop &loop) {
+            return sig.connect(loop, expensive_slot);
+        };
+        for (std::size_t burst : {std::size_t(1), std::size_t(16), std::size_t(256)}) {
+            bench_bursts("direct", emissions, burst, direct);
+            bench_bursts("queued", emissions, burst, queued);
+        }
+    }
+
+    // Connections live in the objects that own them, which are allocated at different times,
+    // so they are far apart on the heap. Reports the time per slot call.
+    template<typename Signal>
+    void bench_slots(std::string const &name, std::size_t slot_count, std::size_t calls) {
+        Signal sig;
+        std::vector<std::unique_ptr<typename Signal::connection>> connections;
+        std::vector<std::unique_ptr<char[]>> neighbours;
+        std::mt19937 random(42);
+        for (std::size_t i = 0; i < slot_count; ++i) {
+            neighbours.push_back(std::make_unique<char[]>(64 + random() % 512));
+            connections.push_back(std::make_unique<typename Signal::connection>(sig.connect(slot)));
+        }
+        std::size_t emissions = std::max<std::size_t>(1, calls / slot_count);
+        double best = 0;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < emissions; ++i) {
+                sig(i);
+            }
+            double ns = since(start);
+            best = repeat == 0 ? ns : std::min(best, ns);
+        }
+        std::size_t slot_calls = emissions * slot_count;
+        std::string full_name = "emit/" + name + "/slots:" + std::to_string(slot_count);
+        std::printf("%-50s %10zu slot calls %10.3f ms %8.2f ns/slot call\n",
+                    full_name.c_str(), slot_calls, best / 1e6, best / slot_calls);
+    }
+
+    bool starts_with(char const *s, char const *prefix) {
+        return std::strncmp(s, prefix, std::strlen(prefix)) == 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t emissions = 2000000;
+    std::size_t max_emitters = 16;
+    std::string selected;
+    for (int i = 1; i < argc; ++i) {
+        if (starts_with(argv[i], "--emissions=")) {
+            emissions = std::strtoull(argv[i] + 12, nullptr, 10);
+        } else if (starts_with(argv[i], "--threads=")) {
+            max_emitters = std::max<std::size_t>(1, std::strtoull(argv[i] + 10, nullptr, 10));
+        } else if (starts_with(argv[i], "--benchmarks=")) {
+            selected = std::string(",") + (argv[i] + 13) + ",";
+        } else {
+            std::fprintf(stderr, "usage: %s [--emissions=N] [--threads=MAX_EMITTERS] [--benchmarks=NAME,...]\n"
+                                 "queued:  N / 100 emissions of a signal with a slow slot, direct and queued to\n"
+                                 "         an event loop, in bursts of 1, 16 and 256\n"
+                                 "scaling: N emissions of a signal with %zu slots from 1, 2, 4, ... MAX_EMITTERS threads\n"
+                                 "dense:   N slot calls of signal and dense_signal with 1, 10, 1000 and 100000 slots\n"
+                                 "(default: all)\n",
+                         argv[0], slots);
+            return 1;
+        }
+    }
+    auto run = [&selected](char const *name) {
+        return selected.empty() || selected.find(std::string(",") + name + ",") != std::string::npos;
+    };
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    if (run("queued")) {
+        bench_queued(emissions / 100);
+    }
+    if (run("scaling")) {
+        for (std::size_t emitters = 1; emitters <= max_emitters; emitters *= 2) {
+            for (bool churn : {false, true}) {
+                bench<locked_signal>("mutex + signal", emitters, emissions, churn);
+                bench<concurrent>("concurrent_signal", emitters, emissions, churn);
+            }
+        }
+    }
+    if (run("dense")) {
+        for (std::size_t slot_count : {1, 10, 1000, 100000}) {
+            bench_slots<signals::signal<void(std::size_t)>>("signal", slot_count, emissions);
+            bench_slots<signals::dense_signal<void(std::size_t)>>("dense_signal", slot_count, emissions);
+        }
+    }
+}
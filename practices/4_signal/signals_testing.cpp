@@ -1,5 +1,15 @@
 #include <gtest/gtest.h>
 #include "signals.h"
+#include "concurrent_signal.h"
+#include "dense_signal.h"
+#include "event_loop.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST(signal_testing, trivial)
 {
@@ -33,6 +43,40 @@ TEST(signal_testing, arguments)
     sig(5, 6, 7);
 }
 
+TEST(signal_testing, move_only_argument)
+{
+    signals::signal<void(std::unique_ptr<int>)> sig;
+    std::unique_ptr<int> got;
+    auto conn = sig.connect([&](std::unique_ptr<int> p) { got = std::move(p); });
+
+    sig(std::make_unique<int>(42));
+
+    ASSERT_NE(nullptr, got);
+    EXPECT_EQ(42, *got);
+}
+
+TEST(signal_testing, last_slot_takes_argument)
+{
+    signals::signal<void(std::shared_ptr<int>)> sig;
+    std::vector<std::shared_ptr<int>> got(3);
+    auto conn1 = sig.connect([&](std::shared_ptr<int> p) { got[0] = std::move(p); });
+    auto conn2 = sig.connect([&](std::shared_ptr<int> p) { got[1] = std::move(p); });
+    long use_count = 0;
+    auto conn3 = sig.connect([&](std::shared_ptr<int> p)
+                             {
+                                 use_count = p.use_count();
+                                 got[2] = std::move(p);
+                             });
+
+    sig(std::make_shared<int>(42));
+
+    // the emission's argument was moved into the last slot rather than copied
+    EXPECT_EQ(3, use_count);
+    EXPECT_EQ(got[0], got[1]);
+    EXPECT_EQ(got[0], got[2]);
+    EXPECT_EQ(3, got[0].use_count());
+}
+
 TEST(signal_testing, empty_connection_move)
 {
     signals::signal<void()>::connection a;
@@ -274,6 +318,545 @@ TEST(signal_testing, move_in_emit_02)
     EXPECT_EQ(1, got1);
 }
 
+TEST(concurrent_signal_testing, trivial)
+{
+    signals::concurrent_signal<void(int)> sig;
+    int got1 = 0;
+    auto conn1 = sig.connect([&](int x) { got1 += x; });
+    int got2 = 0;
+    auto conn2 = sig.connect([&](int x) { got2 += 2 * x; });
+
+    sig(1);
+    sig(2);
+
+    EXPECT_EQ(3, got1);
+    EXPECT_EQ(6, got2);
+}
+
+TEST(concurrent_signal_testing, move_only_argument)
+{
+    signals::concurrent_signal<void(std::unique_ptr<int>)> sig;
+    std::unique_ptr<int> got;
+    auto conn = sig.connect([&](std::unique_ptr<int> p) { got = std::move(p); });
+
+    sig(std::make_unique<int>(42));
+
+    ASSERT_NE(nullptr, got);
+    EXPECT_EQ(42, *got);
+}
+
+TEST(concurrent_signal_testing, every_slot_gets_arguments)
+{
+    signals::concurrent_signal<void(std::string)> sig;
+    std::string got1;
+    auto conn1 = sig.connect([&](std::string s) { got1 = std::move(s); });
+    std::string got2;
+    auto conn2 = sig.connect([&](std::string s) { got2 = std::move(s); });
+
+    sig("a string too long for the small string buffer");
+
+    EXPECT_EQ("a string too long for the small string buffer", got1);
+    EXPECT_EQ(got1, got2);
+}
+
+TEST(concurrent_signal_testing, disconnect)
+{
+    using connection = signals::concurrent_signal<void()>::connection;
+    signals::concurrent_signal<void()> sig;
+    uint32_t got1 = 0;
+    connection conn1 = sig.connect([&] { ++got1; });
+    uint32_t got2 = 0;
+    connection conn2 = sig.connect([&] { ++got2; });
+
+    sig();
+    conn1.disconnect();
+    conn1.disconnect();
+    sig();
+
+    EXPECT_EQ(1, got1);
+    EXPECT_EQ(2, got2);
+
+    connection conn3 = std::move(conn2);
+    sig();
+    EXPECT_EQ(3, got2);
+    conn2 = std::move(conn3);
+    sig();
+    EXPECT_EQ(4, got2);
+    conn2 = connection();
+    sig();
+    EXPECT_EQ(4, got2);
+}
+
+TEST(concurrent_signal_testing, connect_and_disconnect_in_emit)
+{
+    using connection = signals::concurrent_signal<void()>::connection;
+    signals::concurrent_signal<void()> sig;
+    uint32_t got1 = 0;
+    connection conn1;
+    connection conn3;
+    uint32_t got2 = 0;
+    connection conn2 = sig.connect([&]
+                                   {
+                                       ++got2;
+                                       conn1 = sig.connect([&] { ++got1; });
+                                       conn3.disconnect();
+                                   });
+    uint32_t got3 = 0;
+    conn3 = sig.connect([&] { ++got3; });
+
+    sig();
+
+    EXPECT_EQ(0, got1);
+    EXPECT_EQ(1, got2);
+    EXPECT_EQ(0, got3);
+
+    conn2.disconnect();
+    sig();
+
+    EXPECT_EQ(1, got1);
+    EXPECT_EQ(0, got3);
+}
+
+TEST(concurrent_signal_testing, recursive_emit_and_exception)
+{
+    struct test_exception : std::exception
+    {};
+
+    signals::concurrent_signal<void()> sig;
+    uint32_t got1 = 0;
+    auto conn1 = sig.connect([&]
+                             {
+                                 ++got1;
+                                 if (got1 == 1)
+                                     sig();
+                                 else if (got1 == 2)
+                                     throw test_exception();
+                             });
+
+    EXPECT_THROW(sig(), test_exception);
+    EXPECT_EQ(2, got1);
+    sig();
+    EXPECT_EQ(3, got1);
+}
+
+TEST(concurrent_signal_testing, destroy_signal_before_connection)
+{
+    auto sig = std::make_unique<signals::concurrent_signal<void()>>();
+    uint32_t got1 = 0;
+    auto conn1_old = sig->connect([&] { ++got1; });
+
+    sig.reset();
+
+    auto conn1_new = std::move(conn1_old);
+    conn1_new.disconnect();
+}
+
+TEST(concurrent_signal_testing, disconnect_releases_slot)
+{
+    signals::concurrent_signal<void()> sig;
+    auto state = std::make_shared<int>(0);
+    std::weak_ptr<int> weak = state;
+    auto conn = sig.connect([state] { ++*state; });
+    state.reset();
+
+    sig();
+    EXPECT_FALSE(weak.expired());
+    conn.disconnect();
+    EXPECT_TRUE(weak.expired());
+}
+
+// Emitters run while other threads connect and disconnect; a slot must not be called after
+// disconnect() returns, which is when its counter is checked.
+TEST(concurrent_signal_testing, concurrent_emit_connect_disconnect)
+{
+    int const emitters = 3;
+    int const writers = 2;
+    int const rounds = 40;
+    signals::concurrent_signal<void(int)> sig;
+    std::atomic<int> always_called{0};
+    auto always = sig.connect([&](int x) { always_called += x; });
+    std::atomic<bool> done{false};
+    std::atomic<int> errors{0};
+    std::atomic<long> emitted{0};
+
+    std::vector<std::thread> threads;
+    for (int e = 0; e < emitters; ++e)
+    {
+        threads.emplace_back([&]
+                             {
+                                 while (!done.load())
+                                 {
+                                     sig(1);
+                                     ++emitted;
+                                 }
+                             });
+    }
+    std::vector<std::thread> writer_threads;
+    for (int w = 0; w < writers; ++w)
+    {
+        writer_threads.emplace_back([&]
+                                    {
+                                        for (int i = 0; i < rounds; ++i)
+                                        {
+                                            auto calls = std::make_shared<std::atomic<int>>(0);
+                                            auto conn = sig.connect([calls](int x) { *calls += x; });
+                                            std::this_thread::yield();
+                                            conn.disconnect();
+                                            int after_disconnect = calls->load();
+                                            std::this_thread::yield();
+                                            if (calls->load() != after_disconnect)
+                                            {
+                                                ++errors;
+                                            }
+                                        }
+                                    });
+    }
+    for (std::thread& t : writer_threads)
+    {
+        t.join();
+    }
+    done = true;
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(0, errors.load());
+    EXPECT_EQ(emitted.load(), always_called.load());
+}
+
+TEST(queued_connection_testing, runs_on_event_loop)
+{
+    signals::event_loop loop;
+    signals::signal<void(std::string const&, int)> sig;
+    std::vector<std::string> got;
+    auto conn = sig.connect(loop, [&](std::string const& s, int x) { got.push_back(s + std::to_string(x)); });
+
+    std::string arg = "a";
+    sig(arg, 1);
+    arg = "b";
+    sig(arg, 2);
+    EXPECT_TRUE(got.empty());
+
+    EXPECT_EQ(2, loop.run_pending());
+    EXPECT_EQ(std::vector<std::string>({"a1", "b2"}), got);
+    EXPECT_EQ(0, loop.run_pending());
+}
+
+TEST(queued_connection_testing, moves_arguments)
+{
+    signals::event_loop loop;
+    signals::signal<void(std::shared_ptr<int>)> sig;
+    std::shared_ptr<int> got;
+    auto conn = sig.connect(loop, [&](std::shared_ptr<int> p) { got = std::move(p); });
+
+    auto value = std::make_shared<int>(42);
+    sig(value);
+    EXPECT_EQ(2, value.use_count());
+    loop.run_pending();
+    EXPECT_EQ(value, got);
+    EXPECT_EQ(2, value.use_count());
+}
+
+TEST(queued_connection_testing, every_slot_gets_arguments)
+{
+    signals::event_loop loop;
+    signals::signal<void(std::shared_ptr<int>)> sig;
+    std::vector<std::shared_ptr<int>> got(4);
+    auto conn1 = sig.connect(loop, [&](std::shared_ptr<int> p) { got[0] = std::move(p); });
+    auto conn2 = sig.connect([&](std::shared_ptr<int> p) { got[1] = std::move(p); });
+    auto conn3 = sig.connect(loop, [&](std::shared_ptr<int> p) { got[2] = std::move(p); });
+    auto conn4 = sig.connect([&](std::shared_ptr<int> p) { got[3] = std::move(p); });
+
+    auto value = std::make_shared<int>(42);
+    sig(value);
+    loop.run_pending();
+    for (auto const& p : got)
+    {
+        EXPECT_EQ(value, p);
+    }
+}
+
+TEST(queued_connection_testing, disconnect_drops_queued_calls)
+{
+    signals::event_loop loop;
+    signals::signal<void()> sig;
+    uint32_t got1 = 0;
+    auto conn1 = sig.connect(loop, [&] { ++got1; });
+    uint32_t got2 = 0;
+    auto conn2 = sig.connect(loop, [&] { ++got2; });
+
+    sig();
+    conn1.disconnect();
+    loop.run_pending();
+
+    EXPECT_EQ(0, got1);
+    EXPECT_EQ(1, got2);
+}
+
+TEST(queued_connection_testing, exception_keeps_rest_of_batch)
+{
+    struct test_exception : std::exception
+    {};
+
+    signals::event_loop loop;
+    signals::signal<void(int)> sig;
+    std::vector<int> got;
+    auto conn = sig.connect(loop, [&](int x)
+                            {
+                                if (x == 1)
+                                    throw test_exception();
+                                got.push_back(x);
+                            });
+
+    sig(0);
+    sig(1);
+    sig(2);
+    EXPECT_THROW(loop.run_pending(), test_exception);
+    EXPECT_EQ(std::vector<int>({0}), got);
+    loop.run_pending();
+    EXPECT_EQ(std::vector<int>({0, 2}), got);
+}
+
+// Emissions made while the loop is busy are run as one batch without waking it up again.
+TEST(queued_connection_testing, burst_is_one_wakeup)
+{
+    int const burst = 100;
+    signals::event_loop loop;
+    signals::concurrent_signal<void(int)> sig;
+    std::vector<int> got;
+    auto conn = sig.connect(loop, [&](int x) { got.push_back(x); });
+
+    std::thread consumer([&] { loop.run(); });
+    std::promise<void> started;
+    std::promise<void> release;
+    loop.post([&]
+              {
+                  started.set_value();
+                  release.get_future().wait();
+              });
+    started.get_future().wait();
+    std::size_t wakeups = loop.wakeups();
+
+    for (int i = 0; i < burst; ++i)
+    {
+        sig(i);
+    }
+    std::promise<void> drained;
+    loop.post([&] { drained.set_value(); });
+    release.set_value();
+    drained.get_future().wait();
+    loop.stop();
+    consumer.join();
+
+    EXPECT_EQ(wakeups, loop.wakeups());
+    ASSERT_EQ(std::size_t(burst), got.size());
+    for (int i = 0; i < burst; ++i)
+    {
+        EXPECT_EQ(i, got[i]);
+    }
+}
+
+TEST(dense_signal_testing, trivial)
+{
+    signals::dense_signal<void(int)> sig;
+    int got1 = 0;
+    auto conn1 = sig.connect([&](int x) { got1 += x; });
+    int got2 = 0;
+    auto conn2 = sig.connect([&](int x) { got2 += 2 * x; });
+
+    sig(1);
+    sig(2);
+
+    EXPECT_EQ(3, got1);
+    EXPECT_EQ(6, got2);
+    EXPECT_EQ(2, sig.size());
+}
+
+TEST(dense_signal_testing, move_only_argument)
+{
+    signals::dense_signal<void(std::unique_ptr<int>)> sig;
+    std::unique_ptr<int> got;
+    auto conn = sig.connect([&](std::unique_ptr<int> p) { got = std::move(p); });
+
+    sig(std::make_unique<int>(42));
+
+    ASSERT_NE(nullptr, got);
+    EXPECT_EQ(42, *got);
+}
+
+TEST(dense_signal_testing, every_slot_gets_arguments)
+{
+    signals::dense_signal<void(std::string)> sig;
+    std::string got1;
+    auto conn1 = sig.connect([&](std::string s) { got1 = std::move(s); });
+    std::string got2;
+    auto conn2 = sig.connect([&](std::string s) { got2 = std::move(s); });
+
+    sig("a string too long for the small string buffer");
+
+    EXPECT_EQ("a string too long for the small string buffer", got1);
+    EXPECT_EQ(got1, got2);
+}
+
+TEST(dense_signal_testing, disconnect_and_reuse_handles)
+{
+    using connection = signals::dense_signal<void()>::connection;
+    signals::dense_signal<void()> sig;
+    std::vector<int> got(100);
+    std::vector<connection> conns;
+    for (int i = 0; i < 100; ++i)
+    {
+        conns.push_back(sig.connect([&got, i] { ++got[i]; }));
+    }
+    for (int i = 0; i < 100; i += 2)
+    {
+        conns[i].disconnect();
+    }
+    conns[0].disconnect();
+    EXPECT_EQ(50, sig.size());
+    sig();
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i % 2, got[i]);
+    }
+
+    // handles of disconnected slots are reused, but stale connections do not refer to new slots
+    connection stale = std::move(conns[3]);
+    stale.disconnect();
+    int got_new = 0;
+    connection fresh = sig.connect([&] { ++got_new; });
+    stale.disconnect();
+    connection moved = std::move(fresh);
+    sig();
+    EXPECT_EQ(1, got_new);
+    EXPECT_EQ(2, got[1]);
+    EXPECT_EQ(1, got[3]);
+    moved = connection();
+    sig();
+    EXPECT_EQ(1, got_new);
+}
+
+TEST(dense_signal_testing, disconnect_in_emit)
+{
+    using connection = signals::dense_signal<void()>::connection;
+    signals::dense_signal<void()> sig;
+    uint32_t got1 = 0;
+    auto conn1 = std::make_unique<connection>(sig.connect([&] { ++got1; }));
+    uint32_t got2 = 0;
+    std::unique_ptr<connection> conn2;
+    std::unique_ptr<connection> conn3;
+    conn2.reset(new connection(sig.connect([&] { ++got2; conn2.reset(); conn3.reset(); })));
+    uint32_t got3 = 0;
+    conn3 = std::make_unique<connection>(sig.connect([&] { ++got3; }));
+
+    sig();
+
+    EXPECT_EQ(1, got1);
+    EXPECT_EQ(1, got2);
+    EXPECT_EQ(0, got3);
+
+    sig();
+
+    EXPECT_EQ(2, got1);
+    EXPECT_EQ(1, got2);
+    EXPECT_EQ(0, got3);
+    EXPECT_EQ(1, sig.size());
+}
+
+TEST(dense_signal_testing, connect_in_emit)
+{
+    using connection = signals::dense_signal<void()>::connection;
+    signals::dense_signal<void()> sig;
+    std::vector<connection> added;
+    uint32_t got_added = 0;
+    auto conn = sig.connect([&]
+                            {
+                                added.push_back(sig.connect([&] { ++got_added; }));
+                                if (added.size() == 1)
+                                {
+                                    added.front().disconnect();
+                                }
+                            });
+
+    sig();
+    EXPECT_EQ(0, got_added);
+    EXPECT_EQ(1, sig.size());
+
+    sig();
+    EXPECT_EQ(0, got_added);
+    EXPECT_EQ(2, sig.size());
+
+    sig();
+    EXPECT_EQ(1, got_added);
+    EXPECT_EQ(3, sig.size());
+}
+
+TEST(dense_signal_testing, destroy_signal_before_connection)
+{
+    auto sig = std::make_unique<signals::dense_signal<void()>>();
+    uint32_t got1 = 0;
+    auto conn1_old = sig->connect([&] { ++got1; });
+
+    sig.reset();
+
+    auto conn1_new = std::move(conn1_old);
+    conn1_new.disconnect();
+}
+
+TEST(dense_signal_testing, destroy_signal_in_emit)
+{
+    auto sig = std::make_unique<signals::dense_signal<void()>>();
+    uint32_t got1 = 0;
+    auto conn1 = sig->connect([&] { ++got1; });
+    uint32_t got2 = 0;
+    auto conn2 = sig->connect([&, state = std::make_shared<int>(0)]
+                              {
+                                  ++got2;
+                                  if (got2 == 1)
+                                      (*sig)();
+                                  else
+                                      sig.reset();
+                                  ++*state;
+                              });
+    uint32_t got3 = 0;
+    auto conn3 = sig->connect([&] { ++got3; });
+
+    (*sig)();
+
+    EXPECT_EQ(2, got1);
+    EXPECT_EQ(2, got2);
+    EXPECT_EQ(0, got3);
+}
+
+TEST(dense_signal_testing, exception_in_emit)
+{
+    struct test_exception : std::exception
+    {};
+
+    using connection = signals::dense_signal<void()>::connection;
+    signals::dense_signal<void()> sig;
+    uint32_t got1 = 0;
+    connection conn1;
+    conn1 = sig.connect([&]
+                        {
+                            ++got1;
+                            if (got1 == 1)
+                                sig();
+                            else if (got1 == 2)
+                            {
+                                conn1 = sig.connect([&] { ++got1; });
+                                throw test_exception();
+                            }
+                        });
+
+    EXPECT_THROW(sig(), test_exception);
+    EXPECT_EQ(2, got1);
+    EXPECT_EQ(1, sig.size());
+    sig();
+    EXPECT_EQ(3, got1);
+}
+
 int main(int argc, char** argv)
 {
     testing::InitGoogleTest(&argc, argv);